@@ -0,0 +1,215 @@
+// So sánh các inference backend trên cùng model_ver2.onnx và cùng chuỗi frame
+//
+// Mỗi backend x số thread: tạo engine mới, forward vài lần làm nóng rồi forward từng frame (batch 1)
+//   latency: mean / p50 / p95 của 1 lần forward (ms)
+//   thông lượng: số frame / tổng thời gian forward
+//   lệch so với backend tham chiếu (backend đầu tiên, thread lớn nhất):
+//     max |Δ| trên toàn bộ output, số frame có detection sau NMS khác (box lệch > 2px / score > 0.01)
+//
+// Tham số: --backends=opencv,onnxruntime (mặc định mọi backend có trong bản build),
+//          --threads=1,2,4 (mặc định 1, 2, 4... tới số core), --frames=N (mặc định 50),
+//          --source=, --input= (mặc định video SOURCE_VIDEO_PATH qua nguồn opencv; nguồn giả lập không có
+//          bóng thật -> chỉ đo tốc độ và max |Δ|, không so detection)
+// OpenCV DNN dùng thread pool chung -> số thread đặt bằng cv::setNumThreads; ONNX Runtime đặt intra-op.
+
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "detectors/inference_backend.hpp"
+#include "utils/frame_source.hpp"
+
+namespace {
+    const int WARMUP_FORWARDS = 3;
+
+    std::vector<std::string> split_list(const std::string& text) {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (!item.empty()) {
+                items.push_back(item);
+            }
+        }
+        return items;
+    }
+
+    double max_abs_diff(const std::vector<cv::Mat>& a, const std::vector<cv::Mat>& b) {
+        if (a.size() != b.size()) {
+            return INFINITY;
+        }
+        double diff = 0.0;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].total() != b[i].total()) {
+                return INFINITY;
+            }
+            diff = std::max(diff, cv::norm(a[i].reshape(1, 1), b[i].reshape(1, 1), cv::NORM_INF));
+        }
+        return diff;
+    }
+
+    bool same_detections(const BallDetections& a, const BallDetections& b) {
+        if (a.boxes.size() != b.boxes.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.boxes.size(); i++) {
+            const cv::Rect& p = a.boxes[i];
+            const cv::Rect& q = b.boxes[i];
+            if (std::abs(p.x - q.x) > 2 || std::abs(p.y - q.y) > 2 || std::abs(p.width - q.width) > 2
+                || std::abs(p.height - q.height) > 2 || std::abs(a.confidences[i] - b.confidences[i]) > 0.01f) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string source_backend = "opencv";
+    std::string input = Config::SOURCE_VIDEO_PATH;
+    std::vector<std::string> backends = availableInferenceBackends();
+    std::vector<int> thread_counts;
+    int max_frames = 50;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            source_backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--backends=", 11) == 0) {
+            backends = split_list(argv[i] + 11);
+        } else if (std::strncmp(argv[i], "--threads=", 10) == 0) {
+            for (const std::string& item : split_list(argv[i] + 10)) {
+                thread_counts.push_back(std::max(1, std::atoi(item.c_str())));
+            }
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            max_frames = std::max(1, std::atoi(argv[i] + 9));
+        }
+    }
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (thread_counts.empty()) {
+        for (int n = 1; n < cores; n *= 2) {
+            thread_counts.push_back(n);
+        }
+        thread_counts.push_back(cores);
+    }
+    if (backends.empty()) {
+        std::cerr << "[ERROR] Không có backend nào để chạy" << std::endl;
+        return -1;
+    }
+
+    // Frame -> blob letterbox 1 lần, mọi backend nhận đúng cùng input
+    std::unique_ptr<FrameSource> source = createFrameSource(source_backend);
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn [" << source_backend << "]: " << input << std::endl;
+        return -1;
+    }
+    std::vector<cv::Mat> blobs;
+    cv::Size frame_size;
+    cv::Mat frame;
+    while (static_cast<int>(blobs.size()) < max_frames && source->read(frame)) {
+        frame_size = frame.size();
+        blobs.push_back(preprocess_frame(frame));
+    }
+    source->release();
+    if (blobs.empty()) {
+        std::cerr << "[ERROR] Nguồn không có frame nào" << std::endl;
+        return -1;
+    }
+
+    // Frame giả lập không có bóng -> backend nào cũng 0 detection, "det khác" luôn 0 dù output lệch
+    const bool compare_detections = source_backend != "synthetic";
+    if (!compare_detections) {
+        std::cerr << "[WARNING] Nguồn giả lập không có bóng: không so detection giữa các backend" << std::endl;
+    }
+
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load(Config::MODEL_PATH, backends[0]);
+    if (!model) {
+        return -1;
+    }
+
+    const int saved_threads = cv::getNumThreads();
+
+    // Output tham chiếu: backend đầu tiên, nhiều thread nhất
+    std::vector<std::vector<cv::Mat>> reference;
+    std::vector<BallDetections> reference_detections;
+    {
+        cv::setNumThreads(thread_counts.back());
+        std::unique_ptr<InferenceBackend> engine = createInferenceBackend(backends[0], model->onnxBytes(), thread_counts.back());
+        if (!engine) {
+            return -1;
+        }
+        for (const cv::Mat& blob : blobs) {
+            reference.push_back(engine->forward(blob));
+            reference_detections.push_back(decode_detections(reference.back(), frame_size));
+        }
+    }
+
+    std::cout << "[INFO] " << blobs.size() << " frame " << frame_size.width << "x" << frame_size.height
+              << ", input " << Config::MODEL_INPUT_SIZE << ", tham chiếu: " << backends[0] << std::endl;
+    std::cout << cv::format("  %-34s %7s %9s %9s %9s %9s %11s %10s", "backend", "thread", "mean ms", "p50 ms", "p95 ms",
+                            "fps", "max |Δ|", "det khác") << std::endl;
+
+    for (const std::string& name : backends) {
+        for (int threads : thread_counts) {
+            cv::setNumThreads(threads);
+            std::unique_ptr<InferenceBackend> engine;
+            try {
+                engine = createInferenceBackend(name, model->onnxBytes(), threads);
+            } catch (const cv::Exception& e) {
+                std::cerr << "[ERROR] " << name << ": " << e.what() << std::endl;
+            }
+            if (!engine) {
+                break;
+            }
+            std::vector<double> latencies;
+            double diff = 0.0;
+            int mismatched = 0;
+            try {
+                for (int i = 0; i < WARMUP_FORWARDS; i++) {
+                    engine->forward(blobs[0]);
+                }
+                for (size_t i = 0; i < blobs.size(); i++) {
+                    auto start = std::chrono::steady_clock::now();
+                    std::vector<cv::Mat> outputs = engine->forward(blobs[i]);
+                    latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+                    diff = std::max(diff, max_abs_diff(outputs, reference[i]));
+                    if (compare_detections && !same_detections(decode_detections(outputs, frame_size), reference_detections[i])) {
+                        mismatched++;
+                    }
+                }
+            } catch (const cv::Exception& e) {
+                std::cerr << "[ERROR] " << engine->name() << ": " << e.what() << std::endl;
+                break;
+            }
+
+            double total = 0.0;
+            for (double ms : latencies) {
+                total += ms;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            auto percentile = [&](double q) {
+                size_t rank = static_cast<size_t>(std::ceil(q * latencies.size()));
+                return latencies[std::min(latencies.size() - 1, std::max<size_t>(rank, 1) - 1)];
+            };
+            std::string detections = compare_detections ? cv::format("%6d/%-3zu", mismatched, blobs.size())
+                                                        : cv::format("%10s", "-");
+            std::cout << cv::format("  %-34s %7d %9.2f %9.2f %9.2f %9.1f %11.2e ", engine->name().c_str(), threads,
+                                    total / latencies.size(), percentile(0.50), percentile(0.95),
+                                    total > 0.0 ? 1000.0 * latencies.size() / total : 0.0, diff)
+                      << detections << std::endl;
+        }
+    }
+    cv::setNumThreads(saved_threads);
+    return 0;
+}
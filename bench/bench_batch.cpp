@@ -0,0 +1,95 @@
+// Benchmark thông lượng / độ trễ của detect_batch theo batch size (1, 2, 4, 8, 16)
+//
+// Mỗi batch size chạy tổng khoảng --frames=N frame (mặc định 64) qua preprocess + forward +
+// decode, sau 1 lần chạy làm nóng. Frame lấy từ nguồn giả lập (hoặc --source/--input).
+//   thông lượng: frame/giây
+//   độ trễ: thời gian 1 batch = thời gian frame đầu tiên của batch phải chờ kết quả
+//
+// Cần model ở Config::MODEL_PATH, export ONNX với batch động (nếu không, detect_batch
+// tự forward từng frame và batch > 1 sẽ không nhanh hơn).
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "utils/frame_source.hpp"
+
+int main(int argc, char** argv) {
+    std::string backend = "synthetic";
+    std::string input = "default";
+    int total_frames = 64;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            total_frames = std::max(16, std::atoi(argv[i] + 9));
+        }
+    }
+    
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load();
+    if (!model) {
+        return -1;
+    }
+    DetectorSession session(model);
+    
+    // 16 frame đầu của nguồn, dùng lặp lại cho mọi batch size
+    const int max_batch = 16;
+    std::unique_ptr<FrameSource> source = createFrameSource(backend);
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn [" << backend << "]: " << input << std::endl;
+        return -1;
+    }
+    std::vector<cv::Mat> frames;
+    cv::Mat frame;
+    while (static_cast<int>(frames.size()) < max_batch && source->read(frame)) {
+        frames.push_back(frame.clone());
+    }
+    source->release();
+    if (frames.empty()) {
+        std::cerr << "[ERROR] Nguồn không có frame nào" << std::endl;
+        return -1;
+    }
+    std::cout << "[INFO] Frame " << frames[0].cols << "x" << frames[0].rows << ", model input "
+              << Config::MODEL_INPUT_SIZE << "x" << Config::MODEL_INPUT_SIZE << std::endl;
+    
+    double base_fps = 0.0;
+    for (int batch_size : { 1, 2, 4, 8, 16 }) {
+        std::vector<cv::Mat> batch;
+        for (int i = 0; i < batch_size; i++) {
+            batch.push_back(frames[i % frames.size()]);
+        }
+        
+        session.detect_batch(batch);  // Làm nóng (cấp phát layer cho shape mới)
+        
+        int iterations = std::max(3, total_frames / batch_size);
+        double worst_ms = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            auto batch_start = std::chrono::steady_clock::now();
+            session.detect_batch(batch);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batch_start).count();
+            worst_ms = std::max(worst_ms, ms);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        
+        double fps = iterations * batch_size / seconds;
+        double latency_ms = seconds * 1000.0 / iterations;
+        if (batch_size == 1) {
+            base_fps = fps;
+        }
+        std::cout << "  batch " << cv::format("%2d", batch_size) << ": " << cv::format("%7.1f", fps) << " fps"
+                  << " (x" << cv::format("%.2f", base_fps > 0.0 ? fps / base_fps : 0.0) << ")"
+                  << ", độ trễ batch TB " << cv::format("%.1f", latency_ms) << "ms"
+                  << ", max " << cv::format("%.1f", worst_ms) << "ms" << std::endl;
+    }
+    return 0;
+}
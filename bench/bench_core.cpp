@@ -0,0 +1,233 @@
+// Microbenchmark cho phần CPU của mỗi frame (không cần model hay video, input giả lập)
+//
+//   - Tiền xử lý 1080p / 4K: blobFromImage (cũ) vs Letterbox::InputTensor
+//   - decode_detections: output YOLO [1, C, 8400] (C = 5 hoặc 84) với số box vượt ngưỡng khác nhau
+//   - NMSBoxes với N box xếp thành cụm chồng nhau
+//   - BallTracking::Tracker::try_get_main_ball với 1-200 ứng viên mỗi frame
+//   - KalmanUtils::BallKalman update / predict
+//   - Geometry::line_intersection / compute_angle
+//
+// Dùng Google Benchmark, ví dụ:
+//   bench_core --benchmark_filter=Decode --benchmark_repetitions=5
+//   bench_core --benchmark_format=json --benchmark_out=core.json   (so sánh giữa 2 commit)
+// Metrics (histogram độ trễ) để bật như khi chạy thật, nên số đo gồm cả chi phí của nó.
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "detectors/ball_tracking.hpp"
+#include "utils/kalman.hpp"
+#include "utils/geometry.hpp"
+#include "utils/letterbox.hpp"
+
+namespace {
+    const int ANCHORS = 8400;
+
+    /**
+     * @brief Output YOLOv8 giả lập [1, channels, ANCHORS]: mọi anchor có score thấp, `candidates`
+     * anchor vượt CONF_THRESHOLD, tập trung quanh vài quả bóng (giống output thật trước NMS)
+     */
+    cv::Mat make_yolo_output(int channels, int candidates, uint64 seed) {
+        int sizes[] = { 1, channels, ANCHORS };
+        cv::Mat output(3, sizes, CV_32F);
+        float* data = output.ptr<float>();
+        cv::RNG rng(seed);
+        const float input = static_cast<float>(Config::MODEL_INPUT_SIZE);
+        for (int a = 0; a < ANCHORS; a++) {
+            data[0 * ANCHORS + a] = rng.uniform(0.0f, input);
+            data[1 * ANCHORS + a] = rng.uniform(0.0f, input);
+            data[2 * ANCHORS + a] = rng.uniform(4.0f, 40.0f);
+            data[3 * ANCHORS + a] = rng.uniform(4.0f, 40.0f);
+            for (int c = 4; c < channels; c++) {
+                data[c * ANCHORS + a] = rng.uniform(0.0f, 0.3f);
+            }
+        }
+        const int balls = 5;
+        for (int i = 0; i < candidates; i++) {
+            int a = rng.uniform(0, ANCHORS);
+            int ball = i % balls;
+            data[0 * ANCHORS + a] = 100.0f + ball * 100.0f + rng.uniform(-3.0f, 3.0f);
+            data[1 * ANCHORS + a] = 300.0f + rng.uniform(-3.0f, 3.0f);
+            data[2 * ANCHORS + a] = 12.0f + rng.uniform(-1.0f, 1.0f);
+            data[3 * ANCHORS + a] = 12.0f + rng.uniform(-1.0f, 1.0f);
+            data[(4 + Config::BALL_CLASS_ID) * ANCHORS + a] = rng.uniform(0.6f, 0.95f);
+        }
+        return output;
+    }
+
+    /**
+     * @brief Frame BGR 16:9 ngẫu nhiên cao `height` pixel
+     */
+    cv::Mat make_frame(int height) {
+        cv::Mat frame(height, height * 16 / 9, CV_8UC3);
+        cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+        return frame;
+    }
+
+    /**
+     * @brief Detection của `frames` frame liên tiếp: 1 bóng chính bay ngang frame, còn lại đứng yên / rung nhẹ
+     */
+    std::vector<BallDetections> make_tracking_frames(int candidates, int frames) {
+        std::vector<BallDetections> sequence(frames);
+        cv::RNG rng(42);
+        std::vector<cv::Point> statics;
+        for (int i = 1; i < candidates; i++) {
+            statics.emplace_back(rng.uniform(0, 1920), rng.uniform(0, 1080));
+        }
+        for (int f = 0; f < frames; f++) {
+            BallDetections& detections = sequence[f];
+            detections.boxes.emplace_back(200 + f * 25, 500 + (f % 16) * 8, 12, 12);
+            detections.confidences.push_back(0.9f);
+            for (const cv::Point& p : statics) {
+                detections.boxes.emplace_back(p.x + rng.uniform(-2, 3), p.y + rng.uniform(-2, 3), 12, 12);
+                detections.confidences.push_back(rng.uniform(0.5f, 0.8f));
+            }
+        }
+        return sequence;
+    }
+}
+
+// --- Tiền xử lý: blobFromImage (ép vuông, blob mới mỗi frame) vs letterbox vào tensor cấp phát sẵn ---
+static void BM_BlobFromImage(benchmark::State& state) {
+    const cv::Mat frame = make_frame(static_cast<int>(state.range(0)));
+    const cv::Size input_size(Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE);
+    for (auto _ : state) {
+        cv::Mat blob;
+        cv::dnn::blobFromImage(frame, blob, 1.0 / 255.0, input_size, cv::Scalar(), true, false);
+        benchmark::DoNotOptimize(blob.data);
+    }
+    state.SetBytesProcessed(state.iterations() * frame.total() * frame.elemSize());
+}
+BENCHMARK(BM_BlobFromImage)->ArgName("height")->Arg(1080)->Arg(2160)->Unit(benchmark::kMicrosecond);
+
+static void BM_Letterbox(benchmark::State& state) {
+    const cv::Mat frame = make_frame(static_cast<int>(state.range(0)));
+    Letterbox::InputTensor input;
+    for (auto _ : state) {
+        input.fill(frame, Config::MODEL_INPUT_SIZE);
+        cv::Mat blob = input.blob();
+        benchmark::DoNotOptimize(blob.data);
+    }
+    state.SetBytesProcessed(state.iterations() * frame.total() * frame.elemSize());
+}
+BENCHMARK(BM_Letterbox)->ArgName("height")->Arg(1080)->Arg(2160)->Unit(benchmark::kMicrosecond);
+
+// --- YOLO output -> box (gồm NMS) ---
+static void BM_DecodeDetections(benchmark::State& state) {
+    const int channels = static_cast<int>(state.range(0));
+    const int candidates = static_cast<int>(state.range(1));
+    std::vector<cv::Mat> outputs = { make_yolo_output(channels, candidates, 1234) };
+    const cv::Size frame_size(1920, 1080);
+    for (auto _ : state) {
+        BallDetections detections = decode_detections(outputs, frame_size);
+        benchmark::DoNotOptimize(detections.boxes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * ANCHORS);
+}
+BENCHMARK(BM_DecodeDetections)
+    ->ArgNames({ "C", "candidates" })
+    ->ArgsProduct({ { 5, 6, 84 }, { 0, 20, 200 } })
+    ->Unit(benchmark::kMicrosecond);
+
+// --- NMS riêng (N box thành cụm 5 box chồng nhau) ---
+static void BM_NMSBoxes(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    cv::RNG rng(7);
+    std::vector<cv::Rect> boxes;
+    std::vector<float> scores;
+    for (int i = 0; i < count; i++) {
+        int cluster = i / 5;
+        boxes.emplace_back((cluster * 37) % 1900 + rng.uniform(-3, 4), (cluster * 53) % 1060 + rng.uniform(-3, 4), 12, 12);
+        scores.push_back(rng.uniform(0.5f, 0.95f));
+    }
+    std::vector<int> indices;
+    for (auto _ : state) {
+        cv::dnn::NMSBoxes(boxes, scores, Config::CONF_THRESHOLD, 0.4f, indices);
+        benchmark::DoNotOptimize(indices.data());
+    }
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_NMSBoxes)->RangeMultiplier(4)->Range(8, 2048)->Unit(benchmark::kMicrosecond);
+
+// --- Tracker: 1 frame = 1 lần try_get_main_ball, state giữ qua các frame ---
+static void BM_TryGetMainBall(benchmark::State& state) {
+    const int candidates = static_cast<int>(state.range(0));
+    const int frames = 64;
+    std::vector<BallDetections> sequence = make_tracking_frames(candidates, frames);
+    BallTracking::Tracker tracker;
+    int f = 0;
+    for (auto _ : state) {
+        const BallDetections& detections = sequence[f];
+        std::optional<cv::Point> ball = tracker.try_get_main_ball(detections.boxes, detections.confidences);
+        benchmark::DoNotOptimize(ball);
+        if (++f == frames) {
+            // Hết chuỗi -> bóng "nhảy" về đầu, reset để mỗi vòng giống nhau
+            f = 0;
+            state.PauseTiming();
+            tracker.reset();
+            state.ResumeTiming();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * candidates);
+}
+BENCHMARK(BM_TryGetMainBall)->Arg(1)->Arg(5)->Arg(20)->Arg(50)->Arg(100)->Arg(200);
+
+// --- Kalman ---
+static void BM_KalmanUpdate(benchmark::State& state) {
+    KalmanUtils::BallKalman kalman;
+    float x = 100.0f;
+    for (auto _ : state) {
+        cv::Mat prediction = kalman.update_kalman(x, 500.0f + 0.5f * x);
+        benchmark::DoNotOptimize(prediction.data);
+        x = (x > 1800.0f) ? 100.0f : x + 20.0f;
+    }
+}
+BENCHMARK(BM_KalmanUpdate);
+
+static void BM_KalmanPredict(benchmark::State& state) {
+    KalmanUtils::BallKalman kalman;
+    kalman.update_kalman(100.0f, 500.0f);
+    kalman.update_kalman(120.0f, 510.0f);
+    for (auto _ : state) {
+        std::optional<cv::Mat> prediction = kalman.try_predict();
+        benchmark::DoNotOptimize(prediction);
+    }
+}
+BENCHMARK(BM_KalmanPredict);
+
+// --- Geometry (4 điểm quỹ đạo gần nhất như trong track_ball) ---
+static std::vector<cv::Point2f> make_points(int count) {
+    std::vector<cv::Point2f> points;
+    cv::RNG rng(99);
+    for (int i = 0; i < count; i++) {
+        points.emplace_back(rng.uniform(0.0f, 1920.0f), rng.uniform(0.0f, 1080.0f));
+    }
+    return points;
+}
+
+static void BM_LineIntersection(benchmark::State& state) {
+    const std::vector<cv::Point2f> points = make_points(256);
+    size_t i = 0;
+    for (auto _ : state) {
+        auto inter = Geometry::line_intersection(points[i], points[i + 1], points[i + 2], points[i + 3]);
+        benchmark::DoNotOptimize(inter);
+        i = (i + 4) % (points.size() - 3);
+    }
+}
+BENCHMARK(BM_LineIntersection);
+
+static void BM_ComputeAngle(benchmark::State& state) {
+    const std::vector<cv::Point2f> points = make_points(256);
+    size_t i = 0;
+    for (auto _ : state) {
+        double angle = Geometry::compute_angle(points[i], points[i + 1], points[i + 2]);
+        benchmark::DoNotOptimize(angle);
+        i = (i + 3) % (points.size() - 2);
+    }
+}
+BENCHMARK(BM_ComputeAngle);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,154 @@
+// Benchmark chi phí ingest mỗi frame: đọc từ nguồn + tiền xử lý thành blob cho model
+// (Letterbox::InputTensor cấp phát sẵn, đúng đường detector dùng khi chạy thật)
+//
+// So sánh các chế độ trên cùng nguồn:
+//   full-res : nguồn giao frame gốc BGR, letterbox phải resize về MODEL_INPUT_SIZE
+//   scaled   : nguồn giao frame đã scale (setOutputSize, cạnh dài = input), letterbox không resize,
+//              chỉ ghi phần đệm; cũng là nguồn RGB (như --no-output) nếu backend hỗ trợ -> không đảo kênh
+//   i420     : (chỉ --source=vlc) VLC giao I420 đã scale, 1 lần cvtColor YUV -> RGB rồi letterbox
+//
+// Cách dùng:
+//   bench_ingest                                   -> nguồn giả lập 1080p và 4K
+//   bench_ingest --source=vlc --input=a_1080p.mp4 --input=b_4k.mp4 [--frames=300]
+//
+// Với nguồn giả lập, "decode" là vẽ frame -> chỉ đo được phần copy/resize/blob.
+// Muốn thấy lợi ích scale trong decoder thì chạy với file thật qua --source=vlc.
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "utils/frame_source.hpp"
+#include "utils/letterbox.hpp"
+#ifdef HAVE_LIBVLC
+#include "utils/vlc_reader.hpp"
+#endif
+
+struct IngestResult {
+    int frames = 0;
+    cv::Size frame_size;
+    size_t frame_bytes = 0;      // Số byte mỗi frame nguồn giao ra (lease)
+    double read_ms = 0.0;        // Tổng thời gian chờ nguồn
+    double preprocess_ms = 0.0;  // Tổng thời gian letterbox vào tensor
+};
+
+static bool run_ingest(std::unique_ptr<FrameSource> source, const std::string& input, bool yuv_input,
+                       int max_frames, IngestResult& result) {
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn: " << input << std::endl;
+        return false;
+    }
+    
+    FrameLease lease;
+    cv::Mat rgb;
+    Letterbox::InputTensor tensor;
+    tensor.reserve(1, Config::MODEL_INPUT_SIZE);
+    const ChannelOrder order = yuv_input ? ChannelOrder::RGB : source->channelOrder();
+    result = IngestResult();
+    
+    while (result.frames < max_frames) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (!source->readLease(lease)) {
+            break;
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        if (yuv_input) {
+            // YUV -> RGB đúng thứ tự kênh model cần, letterbox không phải đảo kênh
+            cv::cvtColor(lease.mat(), rgb, cv::COLOR_YUV2RGB_I420);
+            tensor.fill(rgb, Config::MODEL_INPUT_SIZE, 0, order);
+        } else {
+            tensor.fill(lease.mat(), Config::MODEL_INPUT_SIZE, 0, order);
+        }
+        auto t2 = std::chrono::steady_clock::now();
+        
+        if (result.frames == 0) {
+            result.frame_size = lease.mat().size();
+            if (yuv_input) {
+                result.frame_size.height = lease.mat().rows * 2 / 3;  // Bỏ phần chroma
+            }
+            result.frame_bytes = lease.mat().total() * lease.mat().elemSize();
+        }
+        result.read_ms += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        result.preprocess_ms += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        result.frames++;
+        lease.release();
+    }
+    source->release();
+    return result.frames > 0;
+}
+
+static std::unique_ptr<FrameSource> make_source(const std::string& backend, const cv::Size& output_size) {
+    FrameSourceOptions options;
+    options.offline_decode = true;
+    options.output_size = output_size;
+    // Thu nhỏ khi decode = chạy không ghi video -> nguồn giao RGB như main --no-output
+    options.rgb_frames = !output_size.empty();
+    return createFrameSource(backend, options);
+}
+
+static void print_result(const char* mode, const IngestResult& r) {
+    double read = r.read_ms / r.frames;
+    double pre = r.preprocess_ms / r.frames;
+    std::cout << "  " << mode << " (" << r.frame_size.width << "x" << r.frame_size.height << ", "
+              << r.frame_bytes / 1024 << " KB, " << r.frames << " frame): read " << cv::format("%.3f", read) << "ms + letterbox "
+              << cv::format("%.3f", pre) << "ms = " << cv::format("%.3f", read + pre) << "ms/frame ("
+              << cv::format("%.1f", 1000.0 / (read + pre)) << " fps)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string backend = "synthetic";
+    std::vector<std::string> inputs;
+    int max_frames = 300;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            inputs.push_back(argv[i] + 8);
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            max_frames = std::max(1, std::atoi(argv[i] + 9));
+        }
+    }
+    if (inputs.empty()) {
+        if (backend != "synthetic") {
+            std::cerr << "[ERROR] Cần ít nhất 1 --input= cho backend " << backend << std::endl;
+            return -1;
+        }
+        inputs = {"1920x1080@30:" + std::to_string(max_frames), "3840x2160@30:" + std::to_string(max_frames)};
+    }
+    
+    const cv::Size model_size(Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE);
+    for (const auto& input : inputs) {
+        std::cout << "[INFO] Ingest [" << backend << "] " << input << std::endl;
+        IngestResult full, scaled;
+        if (!run_ingest(make_source(backend, cv::Size()), input, false, max_frames, full) ||
+            !run_ingest(make_source(backend, model_size), input, false, max_frames, scaled)) {
+            return -1;
+        }
+        print_result("full-res", full);
+        print_result("scaled  ", scaled);
+#ifdef HAVE_LIBVLC
+        if (backend == "vlc") {
+            auto reader = std::make_unique<VLCVideoReader>();
+            reader->setDecodeMode(VLCVideoReader::DecodeMode::Offline, Config::VLC_RING_SLOTS);
+            reader->setPixelLayout(VLCVideoReader::PixelLayout::I420);
+            reader->setOutputSize(model_size);
+            IngestResult yuv;
+            if (run_ingest(std::move(reader), input, true, max_frames, yuv)) {
+                print_result("i420    ", yuv);
+            }
+        }
+#endif
+        
+        double full_ms = (full.read_ms + full.preprocess_ms) / full.frames;
+        double scaled_ms = (scaled.read_ms + scaled.preprocess_ms) / scaled.frames;
+        if (scaled_ms > 0.0) {
+            std::cout << "  -> scaled nhanh hơn " << cv::format("%.2f", full_ms / scaled_ms) << "x" << std::endl;
+        }
+    }
+    return 0;
+}
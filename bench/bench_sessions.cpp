@@ -0,0 +1,97 @@
+// Benchmark thông lượng tổng khi chạy nhiều DetectorSession song song (1, 2, 4, 8 session)
+//
+// Mỗi session có nguồn giả lập riêng và chạy trên 1 thread riêng, xử lý --frames=N frame
+// (mặc định 64) bằng DetectorSession::update (như vòng lặp tuần tự của run_app).
+// Model chỉ load 1 lần (DetectorModel) rồi dùng chung cho mọi session.
+//   fps tổng: tổng số frame của mọi session / thời gian tới khi session cuối xong
+//   fps/session: fps tổng / số session
+//
+// Tham số: --frames=N, --max-sessions=N (mặc định 8), --source=, --input= (mặc định synthetic)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "utils/frame_source.hpp"
+
+int main(int argc, char** argv) {
+    std::string backend = "synthetic";
+    std::string input = "default";
+    int frames_per_session = 64;
+    int max_sessions = 8;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            frames_per_session = std::max(1, std::atoi(argv[i] + 9));
+        } else if (std::strncmp(argv[i], "--max-sessions=", 15) == 0) {
+            max_sessions = std::max(1, std::atoi(argv[i] + 15));
+        }
+    }
+
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load();
+    if (!model) {
+        return -1;
+    }
+
+    double base_fps = 0.0;
+    for (int n = 1; n <= max_sessions; n *= 2) {
+        // Tạo session + nguồn trước khi bấm giờ (tạo Net không tính vào thông lượng)
+        std::vector<std::unique_ptr<DetectorSession>> sessions;
+        std::vector<std::unique_ptr<FrameSource>> sources;
+        for (int i = 0; i < n; i++) {
+            std::unique_ptr<FrameSource> source = createFrameSource(backend);
+            if (!source || !source->open(input)) {
+                std::cerr << "[ERROR] Không mở được nguồn [" << backend << "]: " << input << std::endl;
+                return -1;
+            }
+            sessions.push_back(std::make_unique<DetectorSession>(model));
+            sessions.back()->configure_court(backend, input);
+            sources.push_back(std::move(source));
+        }
+
+        std::atomic<int> total_frames{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; i++) {
+            workers.emplace_back([&, i] {
+                cv::Mat frame;
+                int count = 0;
+                while (count < frames_per_session && sources[i]->read(frame)) {
+                    sessions[i]->update(frame, count);
+                    count++;
+                }
+                total_frames += count;
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (auto& source : sources) {
+            source->release();
+        }
+
+        double fps = seconds > 0.0 ? total_frames / seconds : 0.0;
+        if (n == 1) {
+            base_fps = fps;
+        }
+        std::cout << "  " << cv::format("%2d", n) << " session: " << cv::format("%7.1f", fps) << " fps tổng"
+                  << " (x" << cv::format("%.2f", base_fps > 0.0 ? fps / base_fps : 0.0) << ")"
+                  << ", " << cv::format("%.1f", fps / n) << " fps/session"
+                  << ", " << total_frames << " frame trong " << cv::format("%.2f", seconds) << "s" << std::endl;
+    }
+    return 0;
+}
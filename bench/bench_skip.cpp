@@ -0,0 +1,110 @@
+// Độ chính xác / tốc độ khi bỏ bớt frame inference (--skip=N) và / hoặc chỉ chạy YOLO trên ROI
+// quanh bóng (--roi) so với chạy YOLO cả frame mọi frame
+//
+// 2 session chạy trên cùng chuỗi frame (đọc 1 lần, giữ trong RAM): session gốc (stride 1, không ROI)
+// và session thử (stride N, ROI nếu bật). So vị trí bóng FrameResult::ball từng frame:
+//   lệch (px): mean / p95 / max trên các frame cả 2 đều có bóng
+//   chỉ 1 bên có bóng: số frame session bỏ frame mất bóng / thấy bóng mà session gốc không thấy
+//   YOLO đã chạy, frame tìm cục bộ / ROI, số lần quay lại YOLO cả frame, thời gian xử lý mỗi bên
+//
+// Tham số: --skip=N (mặc định 3, 1 = không bỏ frame), --roi, --frames=N (mặc định 300), --source=, --input=
+// (mặc định video SOURCE_VIDEO_PATH qua nguồn opencv; nguồn giả lập không có bóng thật)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "utils/frame_source.hpp"
+#include "utils/ball_comparison.hpp"
+
+namespace {
+    double run_session(DetectorSession& session, const std::vector<cv::Mat>& frames, std::vector<FrameResult>& results) {
+        results.clear();
+        results.reserve(frames.size());
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < frames.size(); i++) {
+            results.push_back(session.process(frames[i], static_cast<int>(i)));
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string backend = "opencv";
+    std::string input = Config::SOURCE_VIDEO_PATH;
+    int stride = 3;
+    bool use_roi = false;
+    int max_frames = 300;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--skip=", 7) == 0) {
+            stride = std::max(1, std::atoi(argv[i] + 7));
+        } else if (std::strcmp(argv[i], "--roi") == 0) {
+            use_roi = true;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            max_frames = std::max(1, std::atoi(argv[i] + 9));
+        }
+    }
+
+    std::unique_ptr<FrameSource> source = createFrameSource(backend);
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn [" << backend << "]: " << input << std::endl;
+        return -1;
+    }
+    std::vector<cv::Mat> frames;
+    cv::Mat frame;
+    while (static_cast<int>(frames.size()) < max_frames && source->read(frame)) {
+        frames.push_back(frame.clone());
+    }
+    source->release();
+    if (frames.empty()) {
+        std::cerr << "[ERROR] Nguồn không có frame nào" << std::endl;
+        return -1;
+    }
+
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load();
+    if (!model) {
+        return -1;
+    }
+    DetectorSession baseline(model);
+    DetectorSession skipping(model);
+    baseline.configure_court(backend, input);
+    skipping.configure_court(backend, input);
+    skipping.set_inference_stride(stride);
+    use_roi = use_roi && skipping.set_roi_inference(true);
+
+    std::vector<FrameResult> expected;
+    std::vector<FrameResult> actual;
+    double baseline_seconds = run_session(baseline, frames, expected);
+    double skip_seconds = run_session(skipping, frames, actual);
+
+    BallComparison comparison;
+    for (size_t i = 0; i < frames.size(); i++) {
+        comparison.add(expected[i].ball, actual[i].ball);
+    }
+
+    const SkipStats& stats = skipping.skip_stats();
+    const size_t count = frames.size();
+    std::cout << "[INFO] " << count << " frame, skip=" << stride << (use_roi ? ", ROI" : "") << std::endl;
+    std::cout << "  YOLO: " << stats.inferences << "/" << stats.frames << " frame (tiết kiệm "
+              << cv::format("%.1f", 100.0 * (stats.frames - stats.inferences) / std::max(1, stats.frames)) << "%)"
+              << ", tìm cục bộ " << stats.local_frames << ", quay lại YOLO " << stats.fallbacks << " lần"
+              << ", ROI " << stats.roi_frames << ", ROI trượt " << stats.roi_fallbacks << " lần" << std::endl;
+    std::cout << "  Thời gian: gốc " << cv::format("%.2f", baseline_seconds) << "s ("
+              << cv::format("%.1f", count / baseline_seconds) << " fps), bỏ frame " << cv::format("%.2f", skip_seconds)
+              << "s (" << cv::format("%.1f", count / skip_seconds) << " fps, x"
+              << cv::format("%.2f", skip_seconds > 0.0 ? baseline_seconds / skip_seconds : 0.0) << ")" << std::endl;
+    comparison.print(std::cout);
+    return 0;
+}
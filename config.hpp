@@ -23,6 +23,164 @@ namespace Config {
     
     const int BALL_CLASS_ID = 0;
     const int LINE_CLASS_ID = 1;
+    
+    // Kích thước input của model (ảnh vuông MODEL_INPUT_SIZE x MODEL_INPUT_SIZE)
+    const int MODEL_INPUT_SIZE = 640;
+
+    // Engine chạy model: "opencv" (OpenCV DNN, CUDA nếu có GPU), "openvino" (OpenCV build với
+    // OpenVINO), "opencv-int8" (xem INT8_CALIBRATION_DIR) hoặc "onnxruntime" (build với ONNX Runtime).
+    // Ghi đè bằng --backend=
+    const std::string INFERENCE_BACKEND = "opencv";
+
+    // Số thread trong 1 lần forward của ONNX Runtime (0 = mặc định). OpenCV DNN dùng thread pool chung
+    const int INFERENCE_THREADS = 0;
+
+    // Backend "opencv-int8": lượng tử hóa model FP32 sang INT8 (cv::dnn::Net::quantize) bằng ảnh trong
+    // INT8_CALIBRATION_DIR (tạo bằng tools/calibrate_int8 từ video trận đấu). Ảnh đọc 1 lần mỗi process,
+    // mỗi engine (session / đoạn) lượng tử hóa Net riêng. OpenCV không lưu / copy được Net INT8:
+    // muốn bỏ hẳn bước lượng tử hóa lúc khởi động thì xuất model INT8 QDQ / FP16 và chạy --model=<file.onnx>
+    const std::string INT8_CALIBRATION_DIR = "data/calib";
+    const int INT8_CALIBRATION_FRAMES = 64;
+
+    // Số lần forward giả (input rỗng ở MODEL_INPUT_SIZE) trước frame đầu tiên: engine khởi tạo layer /
+    // cấp phát bộ nhớ lúc forward đầu, không để frame thật chịu độ trễ đó. 0 = tắt
+    const int MODEL_WARMUP_RUNS = 2;
+
+    // Thư mục cache graph đã tối ưu (ONNX Runtime: lần sau load thẳng, bỏ bước tối ưu graph).
+    // Tên file theo nội dung model + phiên bản engine; graph tối ưu gắn với CPU của máy tạo ra nó,
+    // không copy cache sang máy khác. "" = tắt
+    const std::string MODEL_CACHE_DIR = "data/cache";
+
+    // Frame được letterbox (scale giữ tỉ lệ) vào input vuông, phần thừa đệm màu này (giống Ultralytics)
+    const int LETTERBOX_PAD_VALUE = 114;
+
+    // === VIDEO ĐẦU RA ===
+    // true: ghi video đã vẽ annotation ra TARGET_VIDEO_PATH (cần decode full-res)
+    // false: chỉ chạy detect, nguồn decode thẳng trong khung MODEL_INPUT_SIZE (giữ tỉ lệ) (ghi đè bằng --no-output)
+    const bool WRITE_OUTPUT_VIDEO = true;
+    
+    // Codec video đầu ra: "mp4v", "h264" (cần FFmpeg có encoder H.264) hoặc "mjpg"
+    // Ghi đè bằng --codec= / --preset= / --quality=
+    const std::string OUTPUT_CODEC = "mp4v";
+    
+    // Preset H.264: ultrafast/superfast/veryfast/... (nhanh hơn = file lớn hơn)
+    const std::string OUTPUT_H264_PRESET = "veryfast";
+    
+    // Chất lượng MJPEG (0-100)
+    const int OUTPUT_QUALITY = 90;
+    
+    // Số frame tối đa chờ encode trên thread của writer
+    const int OUTPUT_QUEUE_CAPACITY = 8;
+
+    // === NGUỒN FRAME ===
+    // Backend mặc định: "vlc", "opencv", "images" (thư mục ảnh) hoặc "synthetic" (giả lập)
+    // Có thể ghi đè bằng tham số dòng lệnh --source=... --input=...
+    const std::string FRAME_SOURCE = "vlc";
+    
+    // FPS gán cho nguồn thư mục ảnh (ảnh không có thông tin thời gian)
+    const double IMAGE_SOURCE_FPS = 30.0;
+    
+    // Nguồn giả lập mặc định (spec "WxH@FPS:FRAMES" ghi đè qua --input=)
+    const int SYNTHETIC_WIDTH = 1920;
+    const int SYNTHETIC_HEIGHT = 1080;
+    const double SYNTHETIC_FPS = 30.0;
+    const int SYNTHETIC_FRAMES = 900;
+
+    // === THAM SỐ ĐỌC VIDEO (VLC) ===
+    // true: VLC decode liên tục vào ring buffer, false: chế độ cũ pause/resume từng frame
+    const bool VLC_RING_MODE = true;
+    
+    // Số slot frame cấp phát sẵn trong ring
+    const int VLC_RING_SLOTS = 8;
+    
+    // Decode offline (nhanh nhất có thể, không bỏ frame) thay vì phát theo fps của file
+    // Có thể ghi đè bằng tham số dòng lệnh --offline / --paced
+    const bool VLC_OFFLINE_DECODE = true;
+    
+    // Build (lần đầu) / load frame index cạnh video (<video>.fidx) để seek chính xác theo frame.
+    // Index chỉ được load / build ở lần seek đầu tiên (open() không chờ demux cả file)
+    const bool VLC_FRAME_INDEX = true;
+    
+    // Thời gian tối đa chờ VLC parse metadata (ms). open() không chờ, chỉ get() chờ khi cần
+    const int VLC_PARSE_TIMEOUT_MS = 2000;
+    
+    // Playback rate khi decode offline (tốc độ thật bị giới hạn bởi consumer qua backpressure)
+    const float VLC_OFFLINE_RATE = 32.0f;
+    
+    // Buffer mạng (ms) cho nguồn stream (rtsp://, udp://, http://...). Nhỏ = trễ thấp, dễ giật
+    const int VLC_NETWORK_CACHING_MS = 300;
+    
+    // Ảnh VLC đã lock() mà quá thời gian này chưa display() coi như bị vout bỏ (ms).
+    // Chỉ lấy lại slot khi ring cạn; phải lớn hơn độ trễ sắp xếp lại B-frame của decoder
+    const int VLC_LOST_PICTURE_MS = 1000;
+    
+    // Khi xử lý chậm hơn nguồn: "oldest" (bỏ frame cũ nhất), "latest" (chỉ giữ frame mới nhất),
+    // "block" (chờ, không bỏ frame) hoặc "auto" (paced -> oldest, offline -> block)
+    // Có thể ghi đè bằng tham số dòng lệnh --drop=...
+    const std::string VLC_DROP_POLICY = "auto";
+
+    // === PIPELINE ===
+    // true: mỗi stage (decode, preprocess, forward, postprocess, annotate, encode) 1 thread
+    // false: vòng lặp tuần tự. Ghi đè bằng --pipeline / --sequential
+    const bool PIPELINE_ENABLED = true;
+    
+    // Số frame tối đa trong hàng đợi giữa 2 stage
+    const int PIPELINE_QUEUE_CAPACITY = 4;
+    
+    // Số frame mỗi lần forward DNN (1 = độ trễ thấp nhất, lớn hơn = thông lượng cao hơn,
+    // cần model ONNX export với batch động). Ghi đè bằng --batch=N
+    const int INFERENCE_BATCH_SIZE = 1;
+
+    // === XỬ LÝ SONG SONG THEO ĐOẠN (1 video dài) ===
+    // >1: chia video thành N đoạn thời gian, mỗi đoạn 1 thread với decoder + Net riêng,
+    // tracking được nối lại sau để kết quả giống hệt chạy tuần tự. Ghi đè bằng --segments=N
+    const int SEGMENT_COUNT = 1;
+
+    // Số frame mỗi đoạn decode thêm trước điểm bắt đầu: decoder ổn định sau seek và
+    // so detection với đoạn trước để phát hiện seek lệch frame
+    const int SEGMENT_OVERLAP_FRAMES = 15;
+
+    // === BỎ BỚT FRAME INFERENCE ===
+    // >1: khi đang bám bóng chắc chắn chỉ chạy YOLO 1 trên N frame; frame ở giữa lấy bóng bằng
+    // Kalman dự đoán + template matching quanh điểm dự đoán. Mất bóng / match kém -> YOLO ngay
+    // frame đó. Cần vòng lặp tuần tự. Ghi đè bằng --skip=N
+    const int INFERENCE_SKIP_STRIDE = 1;
+
+    // Bán kính tìm quanh điểm dự đoán (pixel của video gốc, nguồn thu nhỏ thì scale theo)
+    const int SKIP_SEARCH_RADIUS = 40;
+
+    // Điểm TM_CCOEFF_NORMED tối thiểu để tin kết quả tìm cục bộ
+    const float SKIP_MIN_MATCH_SCORE = 0.6f;
+
+    // === INFERENCE TRÊN VÙNG QUANH BÓNG (ROI) ===
+    // true: frame trước đã thấy bóng thật -> chỉ crop ROI_CROP_SIZE x ROI_CROP_SIZE quanh điểm Kalman
+    // và forward ở ROI_INPUT_SIZE (ít tính toán hơn, bóng giữ nhiều pixel hơn so với ép cả frame).
+    // Crop không thấy bóng / track vừa reset -> chạy cả frame. Cần vòng lặp tuần tự. Bật bằng --roi
+    const bool ROI_INFERENCE = false;
+
+    // Cạnh cửa sổ crop (pixel của video gốc, nguồn thu nhỏ thì scale theo) và input size của model khi chạy ROI
+    const int ROI_CROP_SIZE = 640;
+    const int ROI_INPUT_SIZE = 320;
+
+    // === ĐIỀU CHỈNH CHẤT LƯỢNG THEO TẢI ===
+    // >0: giữ tốc độ xử lý ~ QUALITY_TARGET_FPS; máy không theo kịp thì tắt overlay chi tiết,
+    // giảm input size, bỏ bớt frame inference (Kalman dự đoán bù) và nâng lại khi dư thời gian.
+    // 0: tắt. Ghi đè bằng --target-fps=N
+    const double QUALITY_TARGET_FPS = 0.0;
+
+    // Số frame tính latency trung bình trước mỗi lần quyết định đổi mức
+    const int QUALITY_WINDOW_FRAMES = 30;
+
+    // === METRICS ===
+    // Histogram độ trễ từng bước (decode, forward, NMS, tracking, encode...), chi phí rất thấp
+    // nên bật mặc định (in bảng khi kết thúc). Tắt bằng --no-metrics
+    const bool METRICS_ENABLED = true;
+
+    // Ghi <METRICS_PATH>.json và <METRICS_PATH>.csv khi kết thúc và mỗi METRICS_INTERVAL_S giây
+    // (0 = chỉ ghi khi kết thúc). "" = không ghi file (mặc định, không rải file vào thư mục hiện tại).
+    // Bật bằng --metrics=<path> (ví dụ data/metrics) / --metrics-interval=N
+    const std::string METRICS_PATH = "";
+    const double METRICS_INTERVAL_S = 10.0;
 
     // === THAM SỐ KALMAN ===
     const float PROCESS_NOISE = 0.5f;
@@ -2,6 +2,9 @@
 #include "../config.hpp"
 #include "../utils/geometry.hpp"
 #include "../utils/kalman.hpp"
+#include "../utils/metrics.hpp"
+#include "../utils/letterbox.hpp"
+#include <opencv2/core/hal/intrin.hpp>
 #include "ball_tracking.hpp"
 #include "line_detector.hpp"
 
@@ -10,20 +13,19 @@
 #include <optional>
 #include <cmath>
 #include <cstdlib>
+#include <cstdint>
 #include <fstream>
 #include <vector>
+#include <cstring>
+#include <iterator>
+#include <chrono>
+#include <algorithm>
 #ifdef _WIN32
 #include <windows.h>
 #else
 #include <unistd.h>
 #endif
 
-// --- Biến toàn cục ---
-static cv::dnn::Net net;
-static std::deque<cv::Point> ball_positions;
-static bool bounce_flag = false;
-static std::optional<cv::Point2f> previous_predict = std::nullopt;
-
 // Hàm helper: Kiểm tra file tồn tại
 static bool file_exists(const std::string& path) {
     std::ifstream file(path);
@@ -56,9 +58,9 @@ static std::string find_model_path(const std::string& relative_path) {
     return relative_path; // Trả về đường dẫn gốc nếu không tìm thấy
 }
 
-// --- Hàm khởi tạo ---
-void initialize_detector() {
-    std::string model_path = find_model_path(Config::MODEL_PATH);
+// --- Load model (1 lần cho mọi session) ---
+std::shared_ptr<const DetectorModel> DetectorModel::load(const std::string& requested_path, const std::string& backend) {
+    std::string model_path = find_model_path(requested_path);
     
     std::cout << "[INFO] Loading YOLO ONNX model: " << model_path << std::endl;
     
@@ -66,7 +68,7 @@ void initialize_detector() {
     if (!file_exists(model_path)) {
         std::cerr << "[ERROR] Không tìm thấy file ONNX model!" << std::endl;
         std::cerr << " -> Đường dẫn đã thử: " << model_path << std::endl;
-        std::cerr << " -> Kiểm tra file có tồn tại tại: " << Config::MODEL_PATH << std::endl;
+        std::cerr << " -> Kiểm tra file có tồn tại tại: " << requested_path << std::endl;
         std::cerr << " -> Hoặc thử đường dẫn tuyệt đối trong config.hpp" << std::endl;
         
         // In thư mục hiện tại để debug
@@ -82,144 +84,414 @@ void initialize_detector() {
         }
         #endif
         
-        exit(1);
+        return nullptr;
+    }
+    
+    std::shared_ptr<DetectorModel> model(new DetectorModel());
+    model->path_ = model_path;
+    model->backend_ = backend;
+    
+    // Đọc toàn bộ file vào bộ nhớ: session tạo Net từ buffer, không mở lại file
+    std::ifstream file(model_path, std::ios::binary);
+    model->onnx_bytes_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (model->onnx_bytes_.empty()) {
+        std::cerr << "[ERROR] Không đọc được file ONNX model: " << model_path << std::endl;
+        return nullptr;
+    }
+    if (!Config::MODEL_CACHE_DIR.empty()) {
+        size_t name_start = model_path.find_last_of("/\\");
+        std::string name = model_path.substr(name_start == std::string::npos ? 0 : name_start + 1);
+        name = name.substr(0, name.find_last_of('.'));
+        model->cache_path_ = Config::MODEL_CACHE_DIR + "/" + name + cv::format("-%016llx",
+                             static_cast<unsigned long long>(modelContentHash(model->onnx_bytes_)));
     }
     
     try {
-        net = cv::dnn::readNet(model_path);
-        
-        // Kiểm tra model đã load thành công
-        if (net.empty()) {
-            std::cerr << "[ERROR] Không thể load model ONNX (net.empty())" << std::endl;
-            exit(1);
+        // Parse thử 1 lần để báo lỗi sớm (trước khi tạo session)
+        std::unique_ptr<InferenceBackend> engine = model->createBackend();
+        if (!engine) {
+            return nullptr;
         }
         
-        if (cv::cuda::getCudaEnabledDeviceCount() > 0) {
-            net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-            net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-            std::cout << "[INFO] Sử dụng CUDA backend" << std::endl;
-        } else {
-            net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-            net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-            std::cout << "[INFO] Sử dụng CPU backend" << std::endl;
-        }
-        
-        std::cout << "[INFO] Model đã load thành công!" << std::endl;
+        std::cout << "[INFO] Sử dụng backend " << engine->name() << std::endl;
+        std::cout << "[INFO] Model đã load thành công! (" << model->onnx_bytes_.size() / 1024 << " KB)" << std::endl;
+        model->spare_threads_ = Config::INFERENCE_THREADS;
+        model->spare_backend_ = std::move(engine);
     } catch (const cv::Exception& e) {
         std::cerr << "[ERROR] OpenCV Exception khi load model: " << e.what() << std::endl;
         std::cerr << " -> File: " << model_path << std::endl;
-        exit(1);
+        return nullptr;
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] Exception khi load model: " << e.what() << std::endl;
         std::cerr << " -> File: " << model_path << std::endl;
-        exit(1);
+        return nullptr;
     }
-    KalmanUtils::reset_kalman();
+    return model;
 }
 
-// --- Hàm update hoàn chỉnh (Thay thế hàm update cũ) ---
-cv::Mat update(const cv::Mat& frame, int frame_idx) {
-    cv::Mat annotated_frame = frame.clone();
+std::unique_ptr<InferenceBackend> DetectorModel::createBackend(int threads) const {
+    {
+        std::lock_guard<std::mutex> lock(spare_mutex_);
+        if (spare_backend_ && threads == spare_threads_) {
+            return std::move(spare_backend_);
+        }
+    }
+    return createInferenceBackend(backend_, onnx_bytes_, threads, cache_path_);
+}
 
-    // ====================================================
-    // 1. YOLO INFERENCE & POST-PROCESSING
-    // ====================================================
-    
-    // a. Pre-process
-    cv::Mat blob;
-    cv::dnn::blobFromImage(frame, blob, 1.0/255.0, cv::Size(640, 640), cv::Scalar(), true, false);
-    net.setInput(blob);
-    
-    // b. Inference
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
+// --- Session: state riêng của 1 video ---
+DetectorSession::DetectorSession(std::shared_ptr<const DetectorModel> model, int threads)
+    : model(std::move(model)) {
+    backend = this->model->createBackend(threads);
+}
+
+void DetectorSession::configure_court(const std::string& backend, const std::string& path) {
+    court.configure_source(backend, path);
+}
+
+void DetectorSession::set_inference_stride(int stride) {
+    inference_stride = std::max(1, stride);
+}
+
+void DetectorSession::set_input_order(ChannelOrder order) {
+    input_order_ = order;
+    local_search.set_channel_order(order);
+}
+
+bool DetectorSession::set_roi_inference(bool enabled) {
+    roi_enabled = false;
+    roi_ready = false;
+    if (!enabled) {
+        return true;
+    }
+    // Thử 1 lần ở input ROI như QualityController::probeInputSizes, rồi đưa Net về shape mặc định
+    int roi_sizes[] = { 1, 3, Config::ROI_INPUT_SIZE, Config::ROI_INPUT_SIZE };
+    int full_sizes[] = { 1, 3, Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE };
+    try {
+        run_inference(cv::Mat(4, roi_sizes, CV_32F, cv::Scalar(0)));
+        run_inference(cv::Mat(4, full_sizes, CV_32F, cv::Scalar(0)));
+    } catch (const cv::Exception& e) {
+        std::cerr << "[WARNING] ROI: model không chạy được input " << Config::ROI_INPUT_SIZE << "x" << Config::ROI_INPUT_SIZE
+                  << " (input cố định khi export?), chạy cả frame" << std::endl;
+        return false;
+    }
+    roi_enabled = true;
+    return true;
+}
+
+WarmupStats DetectorSession::warm_up(int runs, int batch_size) {
+    WarmupStats stats;
+    const int size = Config::MODEL_INPUT_SIZE;
+    // Ảnh toàn màu đệm letterbox đi cùng đường preprocess như frame thật (cấp phát tensor, thread pool)
+    cv::Mat dummy(size, size, CV_8UC3, cv::Scalar::all(Config::LETTERBOX_PAD_VALUE));
+    input_tensor.reserve(std::max(1, batch_size), size);
+    auto timed_forward = [&](const cv::Mat& blob) {
+        auto start = std::chrono::steady_clock::now();
+        backend->forward(blob);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.total_ms += ms;
+        return ms;
+    };
+
+    for (int i = 0; i < runs; i++) {
+        input_tensor.fill(dummy, size);
+        stats.last_ms = timed_forward(input_tensor.blob());
+        if (stats.runs++ == 0) {
+            stats.first_ms = stats.last_ms;
+        }
+    }
+    if (batch_size > 1 && model->batchForwardSupported()) {
+        try {
+            for (int i = 0; i < runs; i++) {
+                for (int b = 0; b < batch_size; b++) {
+                    input_tensor.fill(dummy, size, b);
+                }
+                timed_forward(input_tensor.blob(batch_size));
+                stats.runs++;
+            }
+        } catch (const cv::Exception&) {
+            // Model batch cố định: detect_batch tự phát hiện và chuyển sang forward từng frame
+        }
+    }
+    return stats;
+}
+
+void DetectorSession::reset() {
+    roi_ready = false;
+    frames_since_inference = 0;
+    last_ball_box.reset();
+    local_search.clear();
+    ball_positions.clear();
+    bounce_flag = false;
+    previous_predict = std::nullopt;
+    tracker.reset();
+    kalman.reset_kalman();
+}
+
+// --- Các bước xử lý 1 frame (tách riêng để chạy pipeline mỗi bước 1 thread) ---
 
-    // c. Post-process (ĐÃ SỬA ĐỂ TỰ ĐỘNG NHẬN DIỆN SIZE)
+cv::Mat preprocess_frame(const cv::Mat& frame, int input_size, ChannelOrder order) {
+    // Blob mới mỗi lần (giữ được nhiều blob cùng lúc); session / pipeline dùng tensor cấp phát sẵn
+    Letterbox::InputTensor input;
+    return preprocess_frame(frame, input, input_size, order);
+}
+
+cv::Mat preprocess_frame(const cv::Mat& frame, Letterbox::InputTensor& input, int input_size, ChannelOrder order) {
+    // Nguồn đã thu nhỏ sẵn (cạnh dài = input) -> letterbox không resize, chỉ đệm
+    Metrics::ScopedTimer timer(Metrics::PREPROCESS);
+    input.fill(frame, input_size, 0, order);
+    return input.blob();
+}
+
+std::vector<cv::Mat> DetectorSession::run_inference(const cv::Mat& blob) {
+    Metrics::ScopedTimer timer(Metrics::FORWARD);
+    return backend->forward(blob);
+}
+
+cv::Mat preprocess_batch(const std::vector<cv::Mat>& frames, Letterbox::InputTensor& input, ChannelOrder order) {
+    Metrics::ScopedTimer timer(Metrics::PREPROCESS);
+    input.reserve(static_cast<int>(frames.size()), Config::MODEL_INPUT_SIZE);
+    for (size_t i = 0; i < frames.size(); i++) {
+        input.fill(frames[i], Config::MODEL_INPUT_SIZE, static_cast<int>(i), order);
+    }
+    return input.blob(static_cast<int>(frames.size()));
+}
+
+cv::Mat stack_blobs(const std::vector<cv::Mat>& blobs, cv::Mat& buffer) {
+    if (blobs.size() == 1) {
+        return blobs[0];
+    }
+    // [1, C, H, W] x N -> [N, C, H, W], mỗi blob là 1 khối liên tục. create() không cấp phát lại khi cùng kích thước
+    int sizes[] = { static_cast<int>(blobs.size()), blobs[0].size[1], blobs[0].size[2], blobs[0].size[3] };
+    buffer.create(4, sizes, CV_32F);
+    size_t blob_bytes = blobs[0].total() * blobs[0].elemSize();
+    for (size_t i = 0; i < blobs.size(); i++) {
+        std::memcpy(buffer.ptr<uchar>(static_cast<int>(i)), blobs[i].ptr<uchar>(), blob_bytes);
+    }
+    return buffer;
+}
+
+std::vector<std::vector<cv::Mat>> DetectorSession::run_inference_batch(const cv::Mat& batch_blob) {
+    const int batch_size = batch_blob.size[0];
+    std::vector<std::vector<cv::Mat>> per_frame(batch_size);
     
-    // Lấy kích thước thực tế từ output của model
-    // Output chuẩn YOLOv8 thường là [1, channels, anchors] (ví dụ: [1, 5, 8400] hoặc [1, 84, 8400])
-    int dimensions = outputs[0].size[1]; 
-    int rows_count = outputs[0].size[2];
+    // Tách blob/output theo frame: header [1, ...] trỏ vào phần tử thứ i của batch
+    auto slice = [](const cv::Mat& batch, int i) {
+        std::vector<int> sizes(batch.size.p, batch.size.p + batch.dims);
+        sizes[0] = 1;
+        return cv::Mat(batch.dims, sizes.data(), batch.type(), const_cast<uchar*>(batch.ptr<uchar>(i)));
+    };
     
-    // In ra để debug (bạn sẽ thấy nó in ra 5, 6 hoặc 84...)
-    // std::cout << "[DEBUG] Model output dimensions: " << dimensions << ", Anchors: " << rows_count << std::endl;
-
-    // Reshape về đúng kích thước thực tế của model thay vì fix cứng 84
-    cv::Mat output_t = outputs[0].reshape(1, dimensions).t();
+    // Model export với batch cố định = 1 không forward được batch > 1 -> chỉ thử 1 lần rồi chạy từng frame
+    if (batch_size > 1 && model->batchForwardSupported()) {
+        try {
+            std::vector<cv::Mat> outputs = run_inference(batch_blob);
+            for (int i = 0; i < batch_size; i++) {
+                for (const cv::Mat& output : outputs) {
+                    per_frame[i].push_back(slice(output, i).clone());
+                }
+            }
+            return per_frame;
+        } catch (const cv::Exception& e) {
+            model->disableBatchForward();
+            std::cerr << "[WARNING] Model không chạy được batch " << batch_size
+                      << " (batch cố định khi export?), chuyển sang forward từng frame" << std::endl;
+            std::cerr << " -> " << e.what() << std::endl;
+        }
+    }
     
-    float x_scale = (float)frame.cols / 640.0f;
-    float y_scale = (float)frame.rows / 640.0f;
-
-    std::vector<cv::Rect> boxes;
-    std::vector<float> confidences;
+    for (int i = 0; i < batch_size; i++) {
+        per_frame[i] = run_inference(slice(batch_blob, i));
+    }
+    return per_frame;
+}
 
-    float* data = (float*)output_t.data;
+std::vector<BallDetections> DetectorSession::detect_batch(const std::vector<cv::Mat>& frames) {
+    std::vector<BallDetections> results;
+    if (frames.empty()) {
+        return results;
+    }
+    const int count = static_cast<int>(frames.size());
+    cv::Mat blob;
+    {
+        Metrics::ScopedTimer timer(Metrics::PREPROCESS);
+        input_tensor.reserve(count, Config::MODEL_INPUT_SIZE);
+        for (int i = 0; i < count; i++) {
+            input_tensor.fill(frames[i], Config::MODEL_INPUT_SIZE, i, input_order_);
+        }
+        blob = input_tensor.blob(count);
+    }
+    std::vector<std::vector<cv::Mat>> outputs = run_inference_batch(blob);
+    for (size_t i = 0; i < frames.size(); i++) {
+        results.push_back(decode_detections(outputs[i], frames[i].size()));
+    }
+    return results;
+}
 
-    for (int i = 0; i < rows_count; ++i) {
-        // Mỗi hàng dữ liệu
-        float* row = data + (i * dimensions);
-        
-        // 4 giá trị đầu tiên luôn là cx, cy, w, h
-        // Các giá trị từ index 4 trở đi là score của các class
-        float* classes_scores = row + 4;
-        
-        // Tạo ma trận scores với kích thước đúng bằng (dimensions - 4)
-        cv::Mat scores(1, dimensions - 4, CV_32F, classes_scores);
-        
-        cv::Point class_id_point;
-        double max_class_score;
-        cv::minMaxLoc(scores, 0, &max_class_score, 0, &class_id_point);
-
-        // Debug: Nếu điểm số cao bất thường ở góc, in ra xem
-        // if (max_class_score > 0.8) std::cout << "Box: " << row[0] << "," << row[1] << " Score: " << max_class_score << std::endl;
-
-        if (max_class_score > Config::CONF_THRESHOLD) {
-            // Lưu ý: Nếu model chỉ có 1 class (bóng), class_id_point.x sẽ luôn là 0
-            // Nếu model nhiều class, cần check class_id
-            if (dimensions > 5) { 
-                 // Model nhiều class -> Check đúng class ID
-                 if (class_id_point.x != Config::BALL_CLASS_ID) continue;
+// --- Decode output YOLO [1, C, anchors] (hàng = channel) không transpose ---
+
+// Thêm vào `indices` các anchor có score > threshold. Phần lớn anchor dưới ngưỡng ->
+// so 16 anchor / vòng bằng SIMD, chỉ rẽ nhánh khi có anchor vượt ngưỡng
+static void find_above(const float* scores, int count, float threshold, std::vector<int>& indices) {
+    int i = 0;
+#if CV_SIMD128
+    const cv::v_float32x4 t = cv::v_setall_f32(threshold);
+    for (; i <= count - 16; i += 16) {
+        int mask = cv::v_signmask(cv::v_load(scores + i) > t)
+                 | cv::v_signmask(cv::v_load(scores + i + 4) > t) << 4
+                 | cv::v_signmask(cv::v_load(scores + i + 8) > t) << 8
+                 | cv::v_signmask(cv::v_load(scores + i + 12) > t) << 12;
+        for (int bit = 0; mask != 0; bit++, mask >>= 1) {
+            if (mask & 1) {
+                indices.push_back(i + bit);
             }
-            // Nếu model chỉ có 1 class (dimensions == 5), mặc định lấy luôn
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (scores[i] > threshold) {
+            indices.push_back(i);
+        }
+    }
+}
 
-            float cx = row[0]; 
-            float cy = row[1];
-            float w = row[2];  
-            float h = row[3];
-            
-            int left = int((cx - 0.5 * w) * x_scale);
-            int top = int((cy - 0.5 * h) * y_scale);
-            int width = int(w * x_scale);
-            int height = int(h * y_scale);
-            
-            boxes.push_back(cv::Rect(left, top, width, height));
-            confidences.push_back((float)max_class_score);
+// Giống minMaxLoc trên các score class trước đây: anchor thuộc class có score cao nhất,
+// bằng nhau thì class đứng trước thắng
+static bool ball_is_top_class(const float* data, int classes, int anchors, int anchor, float ball_score) {
+    for (int c = 0; c < classes; c++) {
+        if (c == Config::BALL_CLASS_ID) {
+            continue;
+        }
+        float score = data[(4 + c) * anchors + anchor];
+        if (score > ball_score || (score == ball_score && c < Config::BALL_CLASS_ID)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// MultiClass = false: model 1 class (C == 5), score duy nhất là bóng
+template <bool MultiClass>
+static void decode_candidates(const float* data, int dimensions, int anchors, const Letterbox::Transform& letterbox,
+                              std::vector<cv::Rect>& boxes, std::vector<float>& confidences) {
+    const float* ball_scores = data + (MultiClass ? 4 + Config::BALL_CLASS_ID : 4) * anchors;
+    std::vector<int> candidates;
+    find_above(ball_scores, anchors, Config::CONF_THRESHOLD, candidates);
+    for (int a : candidates) {
+        float score = ball_scores[a];
+        if (MultiClass && !ball_is_top_class(data, dimensions - 4, anchors, a, score)) {
+            continue;
         }
+        // 4 hàng đầu: cx, cy, w, h theo input của model
+        boxes.push_back(letterbox.toFrame(data[a], data[anchors + a], data[2 * anchors + a], data[3 * anchors + a]));
+        confidences.push_back(score);
+    }
+}
+
+BallDetections decode_detections(const std::vector<cv::Mat>& outputs, const cv::Size& frame_size, int input_size) {
+    // Output YOLOv8 [1, channels, anchors] (ví dụ [1, 5, 8400] hoặc [1, 84, 8400]), đọc thẳng theo hàng:
+    // lọc hàng score của bóng trước, chỉ đọc box / class khác của vài anchor vượt ngưỡng
+    int dimensions = outputs[0].size[1];
+    int anchors = outputs[0].size[2];
+
+    auto parse_start = std::chrono::steady_clock::now();
+
+    cv::Mat output = outputs[0].isContinuous() ? outputs[0] : outputs[0].clone();
+    const float* data = output.ptr<float>();
+
+    // Input là frame letterbox: bỏ phần đệm rồi chia tỉ lệ scale (như nhau theo 2 trục)
+    Letterbox::Transform letterbox = Letterbox::compute(frame_size, input_size);
+
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    if (dimensions > 5) {
+        decode_candidates<true>(data, dimensions, anchors, letterbox, boxes, confidences);
+    } else {
+        decode_candidates<false>(data, dimensions, anchors, letterbox, boxes, confidences);
     }
     
-    // d. NMS (Non-Maximum Suppression) -> Tạo ra 'indices'
+    Metrics::record(Metrics::PARSE, std::chrono::steady_clock::now() - parse_start);
+    
+    // NMS (Non-Maximum Suppression) -> Tạo ra 'indices'
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, Config::CONF_THRESHOLD, 0.4f, indices);
+    {
+        Metrics::ScopedTimer timer(Metrics::NMS);
+        cv::dnn::NMSBoxes(boxes, confidences, Config::CONF_THRESHOLD, 0.4f, indices);
+    }
     
     // Lọc ra các box cuối cùng và confidence scores tương ứng
-    std::vector<cv::Rect> ball_detections;
-    std::vector<float> ball_confidences;
+    BallDetections result;
     for (int idx : indices) {
-        ball_detections.push_back(boxes[idx]);
-        ball_confidences.push_back(confidences[idx]);
+        result.boxes.push_back(boxes[idx]);
+        result.confidences.push_back(confidences[idx]);
     }
+    return result;
+}
 
-    // ====================================================
-    // ... (Phần 1: YOLO Inference giữ nguyên) ...
+// Hàm helper: box theo tọa độ frame <-> tọa độ video gốc
+static cv::Rect scale_rect(const cv::Rect& r, double scale) {
+    return cv::Rect(cvRound(r.x * scale), cvRound(r.y * scale), cvRound(r.width * scale), cvRound(r.height * scale));
+}
+
+double DetectorSession::native_scale(const cv::Size& frame_size) const {
+    if (native_size_.empty() || frame_size.empty() || native_size_ == frame_size) {
+        return 1.0;
+    }
+    return static_cast<double>(native_size_.width) / frame_size.width;
+}
+
+cv::Size DetectorSession::tracking_size(const cv::Size& frame_size) const {
+    return native_scale(frame_size) == 1.0 ? frame_size : native_size_;
+}
+
+FrameResult DetectorSession::track_ball(const BallDetections& detections, const cv::Size& frame_size, int frame_idx) {
+    // Frame đã thu nhỏ khi decode -> box về tọa độ gốc, ngưỡng của Tracker / Kalman / nảy tính theo pixel gốc
+    const double scale = native_scale(frame_size);
+    BallDetections native;
+    if (scale != 1.0) {
+        native.confidences = detections.confidences;
+        for (const cv::Rect& box : detections.boxes) {
+            native.boxes.push_back(scale_rect(box, scale));
+        }
+    }
+    const BallDetections& tracked = (scale != 1.0) ? native : detections;
+
+    std::optional<cv::Point> center;
+    {
+        Metrics::ScopedTimer timer(Metrics::TRACKING);
+        center = tracker.try_get_main_ball(tracked.boxes, tracked.confidences);
+    }
+    // Box của bóng chính (Tracker trả về tâm của 1 detection) -> template cho tìm cục bộ
+    last_ball_box.reset();
+    if (center.has_value()) {
+        for (const cv::Rect& box : tracked.boxes) {
+            if (box.x + box.width / 2 == center->x && box.y + box.height / 2 == center->y) {
+                last_ball_box = box;
+                break;
+            }
+        }
+    }
+    return track_center(center, tracking_size(frame_size), frame_idx);
+}
+
+FrameResult DetectorSession::track_skipped(const cv::Size& frame_size, int frame_idx) {
+    // Không có detection -> không gọi Tracker (tránh tăng miss của mọi object), đi thẳng nhánh Kalman
+    return track_center(std::nullopt, tracking_size(frame_size), frame_idx);
+}
+
+FrameResult DetectorSession::track_center(std::optional<cv::Point> center, const cv::Size& frame_size, int frame_idx) {
+    FrameResult result;
+    result.frame_idx = frame_idx;
+    // Frame sau chỉ được crop ROI khi frame này có bóng thật (không phải Kalman) và track không reset
+    roi_ready = false;
 
     // ====================================================
     // 2. LOGIC TRACKING & KALMAN FILTER
     // ====================================================
 
-    std::optional<cv::Point> center = BallTracking::try_get_main_ball(ball_detections, ball_confidences);
-    
     int cx, cy;
     bool is_measurement = false; 
+    bool track_restarted = false;
 
     if (center.has_value()) {
         // [CASE 1]: Tìm thấy bóng bằng YOLO
@@ -231,16 +503,15 @@ cv::Mat update(const cv::Mat& frame, int frame_idx) {
         // [CASE 2]: Không thấy bóng -> Dùng Kalman
         // SỬA LỖI: Thêm điều kiện !ball_positions.empty()
         // Nghĩa là: Chỉ dự đoán nếu trước đó đã từng có bóng.
-        if (!ball_positions.empty() && KalmanUtils::is_kfExist() && previous_predict.has_value()) {
+        if (!ball_positions.empty() && kalman.is_kfExist() && previous_predict.has_value()) {
             cx = (int)previous_predict->x;
             cy = (int)previous_predict->y;
             is_measurement = false;
 
-            cv::putText(annotated_frame, "KALMAN PREDICTED", cv::Point(50, 100),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
+            result.kalman_predicted = true;
         } else {
             // Chưa từng thấy bóng bao giờ HOẶC Kalman chưa sẵn sàng -> Bỏ qua
-            return annotated_frame;
+            return result;
         }
     }
 
@@ -251,17 +522,20 @@ cv::Mat update(const cv::Mat& frame, int frame_idx) {
         double dist = std::hypot(cx - last_pos.x, cy - last_pos.y);
         
         if (dist < 5.0) {
-             for (const auto& pos : ball_positions) cv::circle(annotated_frame, pos, 4, cv::Scalar(0, 255, 0), -1);
-             return annotated_frame;
+             roi_ready = is_measurement;
+             result.ball = cv::Point(cx, cy);
+             result.trail.assign(ball_positions.begin(), ball_positions.end());
+             return result;
         }
         else if (dist > 400.0) {
             // Nếu nhảy quá xa -> Coi như bóng mới -> Reset lại từ đầu
-            KalmanUtils::reset_kalman();
+            kalman.reset_kalman();
             ball_positions.clear();
+            track_restarted = true;
             
             // QUAN TRỌNG: Nếu đây là bóng dự đoán (is_measurement == false) mà lại nhảy xa 
             // thì chứng tỏ dự đoán sai -> Return luôn, không lưu điểm này.
-            if (!is_measurement) return annotated_frame; 
+            if (!is_measurement) return result; 
             
             // Nếu là bóng thật (is_measurement == true) -> Tiếp tục chạy xuống để init Kalman mới
         }
@@ -270,28 +544,31 @@ cv::Mat update(const cv::Mat& frame, int frame_idx) {
 
 
     // 4. UPDATE / PREDICT KALMAN
+    auto kalman_start = std::chrono::steady_clock::now();
     if (is_measurement) {
         // Có bóng thực -> Update (Correct phase)
-        cv::Mat kf_res = KalmanUtils::update_kalman((float)cx, (float)cy);
+        cv::Mat kf_res = kalman.update_kalman((float)cx, (float)cy);
         previous_predict = cv::Point2f(kf_res.at<float>(0), kf_res.at<float>(1));
     } else {
         // Bóng dự đoán -> Predict phase cho frame tiếp theo
-        auto pred_mat = KalmanUtils::try_predict();
+        auto pred_mat = kalman.try_predict();
         if (pred_mat.has_value()) {
             previous_predict = cv::Point2f(pred_mat.value().at<float>(0), pred_mat.value().at<float>(1));
         }
     }
+    Metrics::record(Metrics::KALMAN, std::chrono::steady_clock::now() - kalman_start);
 
     // 5. LƯU VỊ TRÍ
+    roi_ready = is_measurement && !track_restarted;
+    result.ball = cv::Point(cx, cy);
     ball_positions.push_back(cv::Point(cx, cy));
     if (ball_positions.size() > 4) ball_positions.pop_front();
 
-    // 6. VẼ TRAIL (Đuôi bóng)
-    for (const auto& pos : ball_positions) {
-        cv::circle(annotated_frame, pos, 4, cv::Scalar(0, 255, 0), -1);
-    }
+    // 6. TRAIL (Đuôi bóng)
+    result.trail.assign(ball_positions.begin(), ball_positions.end());
 
-    // 7. DETECT BOUNCE (Xử lý nảy bóng)
+    // 7. DETECT BOUNCE (Xử lý nảy bóng) - đo tới hết hàm (gồm kiểm tra line In/Out)
+    Metrics::ScopedTimer bounce_timer(Metrics::BOUNCE);
     bool skip_detect_bounce = false;
 
     // --- Cách 1: Giao điểm (Line Intersection) ---
@@ -302,11 +579,8 @@ cv::Mat update(const cv::Mat& frame, int frame_idx) {
             bounce_flag = false;
             cv::Point inter_pt = inter.value();
             
-            cv::circle(annotated_frame, inter_pt, 6, cv::Scalar(0, 0, 255), -1);
-            cv::putText(annotated_frame, "BOUNCE POINT", cv::Point(inter_pt.x + 10, inter_pt.y),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 255), 2);
-            
-            LineDetector::execute(inter_pt.x, inter_pt.y, annotated_frame);
+            result.bounce_point = inter_pt;
+            result.bounce_point_check = court.check(inter_pt.x, inter_pt.y, frame_size);
         }
     }
 
@@ -320,22 +594,188 @@ cv::Mat update(const cv::Mat& frame, int frame_idx) {
 
         if (angle_deg < 150.0 && !bounce_flag) {
             bounce_flag = true;
-            cv::putText(annotated_frame, "BOUNCE", cv::Point(50, 50),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 255, 255), 2);
+            result.bounce = true;
             // Có thể gọi LineDetector ở đây nếu muốn bắt điểm nảy ngay lập tức
-             LineDetector::execute(p1.x, p1.y, annotated_frame);
+            result.bounce_check = court.check(p1.x, p1.y, frame_size);
         } else if (angle_deg >= 150.0) {
             bounce_flag = false;
         }
 
+        // Góc để visualize khi annotate
+        result.angle_deg = angle_deg;
+        result.angle_points[0] = p0;
+        result.angle_points[1] = p1;
+        result.angle_points[2] = p2;
+    }
+
+    return result;
+}
+
+void annotate_frame(cv::Mat& annotated_frame, const FrameResult& result, bool detailed) {
+    Metrics::ScopedTimer timer(Metrics::DRAW);
+    if (result.kalman_predicted) {
+        cv::putText(annotated_frame, "KALMAN PREDICTED", cv::Point(50, 100),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
+    } else if (result.local_search) {
+        cv::putText(annotated_frame, "LOCAL SEARCH", cv::Point(50, 100),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 2);
+    }
+
+    // VẼ TRAIL (Đuôi bóng)
+    for (const auto& pos : result.trail) {
+        cv::circle(annotated_frame, pos, 4, cv::Scalar(0, 255, 0), -1);
+    }
+
+    if (result.bounce_point.has_value()) {
+        cv::Point inter_pt = result.bounce_point.value();
+        cv::circle(annotated_frame, inter_pt, 6, cv::Scalar(0, 0, 255), -1);
+        cv::putText(annotated_frame, "BOUNCE POINT", cv::Point(inter_pt.x + 10, inter_pt.y),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 255), 2);
+        if (detailed && result.bounce_point_check.has_value()) {
+            LineDetector::draw(result.bounce_point_check.value(), annotated_frame);
+        }
+    }
+
+    if (result.bounce) {
+        cv::putText(annotated_frame, "BOUNCE", cv::Point(50, 50),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(0, 255, 255), 2);
+        if (detailed && result.bounce_check.has_value()) {
+            LineDetector::draw(result.bounce_check.value(), annotated_frame);
+        }
+    }
+
+    if (detailed && result.angle_deg.has_value()) {
+        const cv::Point& p0 = result.angle_points[0];
+        const cv::Point& p1 = result.angle_points[1];
+        const cv::Point& p2 = result.angle_points[2];
+
         // Visualize góc để debug
-        std::string angle_str = cv::format("%.1f deg", angle_deg);
+        std::string angle_str = cv::format("%.1f deg", result.angle_deg.value());
         cv::putText(annotated_frame, angle_str, cv::Point(p1.x + 10, p1.y - 10),
                     cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 255), 1);
         
         cv::arrowedLine(annotated_frame, p1, p0, cv::Scalar(200, 220, 100), 2);
         cv::arrowedLine(annotated_frame, p1, p2, cv::Scalar(120, 255, 160), 2);
     }
+}
+
+bool DetectorSession::needs_inference() const {
+    return inference_stride <= 1
+        || frames_since_inference + 1 >= inference_stride
+        || !local_search.has_template()
+        || !previous_predict.has_value()
+        || !kalman.is_kfExist();
+}
 
+std::optional<FrameResult> DetectorSession::track_local(const cv::Mat& frame, int frame_idx) {
+    std::optional<BallTracking::LocalMatch> match;
+    {
+        Metrics::ScopedTimer timer(Metrics::LOCAL_SEARCH);
+        // Điểm dự đoán / bán kính theo pixel gốc -> pixel của frame đưa vào
+        const double scale = native_scale(frame.size());
+        match = local_search.search(frame, previous_predict.value() / scale,
+                                    std::max(1, cvRound(Config::SKIP_SEARCH_RADIUS / scale)));
+    }
+    if (!match.has_value() || match->score < Config::SKIP_MIN_MATCH_SCORE) {
+        return std::nullopt;
+    }
+    // Kết quả match đi qua Tracker như 1 detection -> object bóng chính vẫn được cập nhật vị trí,
+    // lần YOLO sau vẫn khớp được với object cũ
+    BallDetections detections;
+    detections.boxes.push_back(match->box);
+    detections.confidences.push_back(match->score);
+    FrameResult result = track_ball(detections, frame.size(), frame_idx);
+    result.local_search = true;
+    return result;
+}
+
+BallDetections DetectorSession::detect_frame(const cv::Mat& frame, int input_size) {
+    cv::Mat blob;
+    {
+        Metrics::ScopedTimer timer(Metrics::PREPROCESS);
+        input_tensor.fill(frame, input_size, 0, input_order_);
+        blob = input_tensor.blob();
+    }
+    std::vector<cv::Mat> outputs = run_inference(blob);
+    return decode_detections(outputs, frame.size(), input_size);
+}
+
+std::optional<BallDetections> DetectorSession::detect_roi(const cv::Mat& frame, int input_size) {
+    // Cửa sổ vuông quanh điểm dự đoán, dời vào trong frame (giữ kích thước) -> không méo tỉ lệ.
+    // Cạnh cửa sổ / điểm dự đoán theo pixel gốc -> pixel của frame đưa vào
+    const double scale = native_scale(frame.size());
+    int side = std::min({ cvRound(Config::ROI_CROP_SIZE / scale), frame.cols, frame.rows });
+    cv::Point2f center = previous_predict.value() / scale;
+    cv::Rect roi(cvRound(center.x) - side / 2, cvRound(center.y) - side / 2, side, side);
+    roi.x = std::clamp(roi.x, 0, frame.cols - side);
+    roi.y = std::clamp(roi.y, 0, frame.rows - side);
+
+    BallDetections detections = detect_frame(frame(roi), std::min(input_size, Config::ROI_INPUT_SIZE));
+    if (detections.boxes.empty()) {
+        return std::nullopt;
+    }
+    // Tọa độ trong crop -> tọa độ frame
+    for (cv::Rect& box : detections.boxes) {
+        box += roi.tl();
+    }
+    return detections;
+}
+
+// --- Hàm update hoàn chỉnh: chạy tuần tự mọi bước trên 1 frame ---
+cv::Mat DetectorSession::update(const cv::Mat& frame, int frame_idx, const ProcessingQuality& quality) {
+    cv::Mat annotated_frame = frame.clone();
+    FrameResult result = process(frame, frame_idx, quality);
+    annotate_frame(annotated_frame, result, quality.detailed_overlay);
     return annotated_frame;
-}
\ No newline at end of file
+}
+
+FrameResult DetectorSession::process(const cv::Mat& frame, int frame_idx, const ProcessingQuality& quality) {
+    FrameResult result;
+    skip.frames++;
+    if (!quality.run_inference) {
+        // Bỏ inference frame này (máy không theo kịp) -> chỉ dự đoán bằng Kalman
+        result = track_skipped(frame.size(), frame_idx);
+    } else {
+        // Đang bám bóng chắc chắn -> thử tìm cục bộ trước, không đủ tin cậy thì YOLO ngay frame này
+        std::optional<FrameResult> local;
+        if (!needs_inference()) {
+            local = track_local(frame, frame_idx);
+            if (!local.has_value()) {
+                skip.fallbacks++;
+            }
+        }
+
+        if (local.has_value()) {
+            result = std::move(local.value());
+            frames_since_inference++;
+            skip.local_frames++;
+        } else {
+            // 1. YOLO INFERENCE & POST-PROCESSING (crop quanh bóng nếu được, không thấy -> cả frame)
+            std::optional<BallDetections> detections;
+            if (roi_enabled && roi_ready && previous_predict.has_value()) {
+                detections = detect_roi(frame, quality.input_size);
+                if (detections.has_value()) {
+                    skip.roi_frames++;
+                } else {
+                    skip.roi_fallbacks++;
+                }
+            }
+            if (!detections.has_value()) {
+                detections = detect_frame(frame, quality.input_size);
+            }
+
+            // 2-7. TRACKING, KALMAN, BOUNCE
+            result = track_ball(detections.value(), frame.size(), frame_idx);
+            skip.inferences++;
+            frames_since_inference = 0;
+
+            // Template mới từ box YOLO; không thấy bóng -> bỏ template để frame sau chạy YOLO tiếp
+            if (inference_stride > 1 && last_ball_box.has_value() && result.ball.has_value() && !result.kalman_predicted) {
+                local_search.set_template(frame, scale_rect(last_ball_box.value(), 1.0 / native_scale(frame.size())));
+            } else {
+                local_search.clear();
+            }
+        }
+    }
+    return result;
+}
@@ -1,17 +1,289 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <vector>
+#include <deque>
+#include <optional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "../config.hpp"
+#include "../utils/kalman.hpp"
+#include "../utils/letterbox.hpp"
+#include "inference_backend.hpp"
+#include "ball_tracking.hpp"
+#include "line_detector.hpp"
 
 /**
- * @brief Khởi tạo các tài nguyên (Load Model YOLO, Reset Kalman).
- * Cần gọi hàm này 1 lần trong main trước khi chạy vòng lặp.
+ * @brief Detection bóng của 1 frame sau NMS (tọa độ theo frame gốc)
  */
-void initialize_detector();
+struct BallDetections {
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+};
 
 /**
- * @brief Hàm xử lý chính cho từng frame (tương đương logic update trong Python).
- * * @param frame Ảnh đầu vào từ video.
- * @param frame_idx Số thứ tự của frame (để debug hoặc hiển thị).
- * @return cv::Mat Frame đã được vẽ các thông tin (bbox, đường bóng, bounce, line...).
+ * @brief Kết quả tracking / bounce của 1 frame, đủ để vẽ annotation mà không cần state
  */
-cv::Mat update(const cv::Mat& frame, int frame_idx);
\ No newline at end of file
+struct FrameResult {
+    int frame_idx = 0;
+    bool kalman_predicted = false;                  // Vị trí bóng lấy từ Kalman (YOLO không thấy)
+    bool local_search = false;                      // Frame bỏ inference, bóng tìm bằng template matching
+    std::optional<cv::Point> ball;                  // Vị trí bóng frame này (nếu có)
+    std::vector<cv::Point> trail;                   // Đuôi bóng (tối đa 4 điểm)
+    std::optional<cv::Point> bounce_point;          // Điểm nảy tìm bằng giao điểm quỹ đạo
+    std::optional<LineDetector::LineCheck> bounce_point_check;
+    bool bounce = false;                            // Nảy phát hiện bằng đổi góc
+    std::optional<LineDetector::LineCheck> bounce_check;
+    std::optional<double> angle_deg;                // Góc tại điểm giữa của 3 vị trí gần nhất
+    cv::Point angle_points[3];
+};
+
+/**
+ * @brief Thống kê chế độ bỏ bớt frame inference (DetectorSession::set_inference_stride)
+ * và inference trên ROI (DetectorSession::set_roi_inference)
+ */
+struct SkipStats {
+    int frames = 0;          // Số frame đã xử lý
+    int inferences = 0;      // Số frame chạy YOLO
+    int local_frames = 0;    // Số frame dùng Kalman + tìm cục bộ thay YOLO
+    int fallbacks = 0;       // Số lần tìm cục bộ không đủ tin cậy -> chạy YOLO ngay frame đó
+    int roi_frames = 0;      // Số frame YOLO chỉ chạy trên ROI quanh bóng
+    int roi_fallbacks = 0;   // Số lần ROI không thấy bóng -> chạy lại cả frame
+};
+
+/**
+ * @brief Thời gian warm-up engine (DetectorSession::warm_up)
+ */
+struct WarmupStats {
+    int runs = 0;               // Số lần forward giả đã chạy
+    double first_ms = 0.0;      // Lần đầu: khởi tạo layer / cấp phát (frame đầu tiên sẽ chịu nếu không warm-up)
+    double last_ms = 0.0;       // Lần cuối: gần với độ trễ forward ổn định
+    double total_ms = 0.0;
+};
+
+/**
+ * @brief Mức chất lượng xử lý 1 frame (QualityController hạ xuống khi máy không theo kịp)
+ */
+struct ProcessingQuality {
+    int input_size = Config::MODEL_INPUT_SIZE;  // Kích thước input của model (bội số của 32)
+    bool run_inference = true;                  // false: không forward, vị trí bóng lấy từ Kalman
+    bool detailed_overlay = true;               // false: không vẽ line sân và góc (chỉ trail + bounce)
+};
+
+/**
+ * @brief Model YOLO đã load, read-only và dùng chung giữa mọi DetectorSession
+ * 
+ * Engine (cv::dnn::Net, Ort::Session) không cho 2 thread forward cùng lúc trên 1 instance,
+ * nên model giữ bytes ONNX trong bộ nhớ (đọc file 1 lần) và mỗi session tạo backend riêng từ đó.
+ * Engine tạo lúc load() để kiểm tra model được giữ lại cho session đầu tiên (không parse /
+ * lượng tử hóa lại lần 2).
+ */
+class DetectorModel {
+public:
+    /**
+     * @brief Tìm và đọc file ONNX vào bộ nhớ, kiểm tra parse được
+     * @param model_path Đường dẫn model (thử thêm ../ và ../../ như trước)
+     * @param backend Engine chạy model (xem createInferenceBackend)
+     * @return nullptr nếu không tìm thấy / không load được / backend không có (đã in [ERROR])
+     */
+    static std::shared_ptr<const DetectorModel> load(const std::string& model_path = Config::MODEL_PATH,
+                                                     const std::string& backend = Config::INFERENCE_BACKEND);
+
+    /**
+     * @brief Tạo 1 instance engine mới từ buffer (lần đầu: trả engine đã tạo lúc load() nếu cùng threads)
+     * @param threads Số thread trong 1 lần forward (0 = mặc định, xem createInferenceBackend)
+     */
+    std::unique_ptr<InferenceBackend> createBackend(int threads = Config::INFERENCE_THREADS) const;
+
+    const std::string& path() const { return path_; }
+    /**
+     * @brief Tiền tố file cache graph trong Config::MODEL_CACHE_DIR (tên model + hash nội dung), "" = tắt
+     */
+    const std::string& cachePath() const { return cache_path_; }
+    const std::string& backend() const { return backend_; }
+    const std::vector<uchar>& onnxBytes() const { return onnx_bytes_; }
+
+    /**
+     * @brief Model export với batch cố định = 1 không forward được batch > 1.
+     * Session đầu tiên phát hiện sẽ tắt cờ cho mọi session khác.
+     */
+    bool batchForwardSupported() const { return batch_forward_supported_.load(); }
+    void disableBatchForward() const { batch_forward_supported_.store(false); }
+
+private:
+    DetectorModel() = default;
+
+    std::string path_;
+    std::string backend_;
+    std::string cache_path_;
+    std::vector<uchar> onnx_bytes_;
+    mutable std::atomic<bool> batch_forward_supported_{true};
+    mutable std::mutex spare_mutex_;
+    mutable std::unique_ptr<InferenceBackend> spare_backend_;  // Engine của load(), chờ session đầu tiên
+    int spare_threads_ = 0;
+};
+
+/**
+ * @brief Toàn bộ state xử lý 1 video: engine riêng, tracker, Kalman, line sân, lịch sử bóng.
+ * 
+ * Không có biến toàn cục -> nhiều session chạy song song trên nhiều thread (mỗi session
+ * 1 video/luồng). Bản thân 1 session không thread-safe: mỗi method chỉ 1 thread gọi,
+ * track_ball phải nhận frame theo đúng thứ tự.
+ */
+class DetectorSession {
+public:
+    /**
+     * @param threads Số thread trong 1 lần forward của engine (0 = mặc định)
+     */
+    explicit DetectorSession(std::shared_ptr<const DetectorModel> model, int threads = Config::INFERENCE_THREADS);
+
+    /**
+     * @brief Nguồn lấy ảnh tham chiếu tìm line sân (xem LineDetector::CourtLines)
+     */
+    void configure_court(const std::string& backend, const std::string& path);
+
+    /**
+     * @brief Xóa state tracking (bắt đầu video mới, giữ engine và line sân)
+     */
+    void reset();
+
+    /**
+     * @brief Bỏ bớt frame inference khi đang bám bóng chắc chắn (chỉ áp dụng trong update() / process())
+     * 
+     * stride > 1: YOLO chạy tối đa 1 trên stride frame; frame ở giữa lấy bóng bằng template
+     * matching quanh điểm Kalman dự đoán. Chưa có bóng / match dưới ngưỡng -> YOLO ngay frame đó.
+     */
+    void set_inference_stride(int stride);
+    const SkipStats& skip_stats() const { return skip; }
+
+    /**
+     * @brief Thứ tự kênh của frame đưa vào session (FrameSource::channelOrder() của nguồn).
+     * Frame RGB vào thẳng tensor không đảo kênh; annotation vẽ theo màu BGR nên chỉ dùng khi không ghi video
+     */
+    void set_input_order(ChannelOrder order);
+    ChannelOrder input_order() const { return input_order_; }
+
+    /**
+     * @brief Kích thước gốc của video (FrameSource::nativeFrameSize()). Nguồn thu nhỏ khi decode
+     * (--no-output) -> box được đưa về tọa độ gốc trước Tracker, mọi ngưỡng pixel (kích thước bóng,
+     * khoảng cách nhảy, vùng tìm cục bộ / ROI) và FrameResult giữ nguyên như khi decode full-res.
+     * Size rỗng = tọa độ của frame đưa vào
+     */
+    void set_native_size(const cv::Size& size) { native_size_ = size; }
+
+    /**
+     * @brief YOLO chỉ chạy trên vùng Config::ROI_CROP_SIZE quanh điểm Kalman ở input
+     * Config::ROI_INPUT_SIZE khi frame trước đã thấy bóng (chỉ áp dụng trong update() / process()).
+     * ROI không có detection -> chạy lại cả frame ngay frame đó.
+     * @return false nếu model không chạy được input ROI (input cố định khi export), ROI tắt
+     */
+    bool set_roi_inference(bool enabled);
+
+    /**
+     * @brief Forward giả `runs` lần ở MODEL_INPUT_SIZE trước frame thật đầu tiên (engine khởi tạo
+     * layer / cấp phát lúc forward đầu). Không ghi vào Metrics.
+     * Gọi sau set_roi_inference / QualityController::probeInputSizes để engine dừng ở shape mặc định.
+     * @param batch_size > 1: chạy thêm ở shape batch (pipeline / chia đoạn), bỏ qua nếu model không hỗ trợ
+     */
+    WarmupStats warm_up(int runs = Config::MODEL_WARMUP_RUNS, int batch_size = 1);
+
+    /**
+     * @brief Hàm xử lý chính cho từng frame (tương đương logic update trong Python).
+     * * @param frame Ảnh đầu vào từ video.
+     * @param frame_idx Số thứ tự của frame (để debug hoặc hiển thị).
+     * @return cv::Mat Frame đã được vẽ các thông tin (bbox, đường bóng, bounce, line...).
+     */
+    cv::Mat update(const cv::Mat& frame, int frame_idx, const ProcessingQuality& quality = ProcessingQuality());
+
+    /**
+     * @brief update() không vẽ: chỉ trả kết quả tracking của frame
+     */
+    FrameResult process(const cv::Mat& frame, int frame_idx, const ProcessingQuality& quality = ProcessingQuality());
+
+    /**
+     * @brief Các bước của update() tách riêng (chạy tuần tự theo đúng thứ tự:
+     * preprocess_frame -> run_inference -> decode_detections -> track_ball -> annotate_frame).
+     */
+    std::vector<cv::Mat> run_inference(const cv::Mat& blob);
+    FrameResult track_ball(const BallDetections& detections, const cv::Size& frame_size, int frame_idx);
+
+    /**
+     * @brief Thay track_ball cho frame không chạy inference: bóng lấy từ Kalman,
+     * Tracker không tính frame này là mất dấu
+     */
+    FrameResult track_skipped(const cv::Size& frame_size, int frame_idx);
+
+    /**
+     * @brief Batch: N frame -> 1 blob [N, 3, H, W] -> 1 lần forward (tận dụng GEMM/SIMD tốt hơn batch 1)
+     * Model ONNX phải export với batch động; nếu không, tự động forward từng frame.
+     * Kết quả trả theo đúng thứ tự frame, track_ball vẫn phải được gọi lần lượt từng frame.
+     */
+    std::vector<BallDetections> detect_batch(const std::vector<cv::Mat>& frames);
+
+    /**
+     * @brief Forward 1 blob batch, trả output của từng frame (cùng dạng với run_inference)
+     */
+    std::vector<std::vector<cv::Mat>> run_inference_batch(const cv::Mat& batch_blob);
+
+private:
+    FrameResult track_center(std::optional<cv::Point> center, const cv::Size& frame_size, int frame_idx);
+    double native_scale(const cv::Size& frame_size) const;  // Pixel gốc / pixel frame
+    cv::Size tracking_size(const cv::Size& frame_size) const;
+    bool needs_inference() const;
+    std::optional<FrameResult> track_local(const cv::Mat& frame, int frame_idx);
+    BallDetections detect_frame(const cv::Mat& frame, int input_size);
+    std::optional<BallDetections> detect_roi(const cv::Mat& frame, int input_size);
+
+    std::shared_ptr<const DetectorModel> model;
+    std::unique_ptr<InferenceBackend> backend;
+    Letterbox::InputTensor input_tensor;        // Cấp phát 1 lần, dùng lại mỗi frame / batch
+    ChannelOrder input_order_ = ChannelOrder::BGR;
+    cv::Size native_size_;
+    std::deque<cv::Point> ball_positions;
+    bool bounce_flag = false;
+    std::optional<cv::Point2f> previous_predict;
+    BallTracking::Tracker tracker;
+    KalmanUtils::BallKalman kalman;
+    LineDetector::CourtLines court;
+
+    // Bỏ bớt frame inference
+    int inference_stride = 1;
+    int frames_since_inference = 0;
+    std::optional<cv::Rect> last_ball_box;      // Box YOLO của bóng chính ở lần track_ball gần nhất
+    BallTracking::LocalSearch local_search;
+    SkipStats skip;
+
+    // Inference trên ROI
+    bool roi_enabled = false;
+    bool roi_ready = false;                     // Frame trước có bóng thật và track không vừa reset
+};
+
+/**
+ * @brief Các bước không có state (chạy được song song, không cần session)
+ * Blob letterbox (giữ tỉ lệ frame); decode_detections tính lại vị trí frame trong input từ
+ * frame_size + input_size để đưa box về tọa độ frame.
+ */
+cv::Mat preprocess_frame(const cv::Mat& frame, int input_size = Config::MODEL_INPUT_SIZE,
+                         ChannelOrder order = ChannelOrder::BGR);
+// Ghi vào tensor của người gọi (ví dụ lấy từ Letterbox::TensorPool), blob dùng chung bộ nhớ với tensor
+cv::Mat preprocess_frame(const cv::Mat& frame, Letterbox::InputTensor& input, int input_size = Config::MODEL_INPUT_SIZE,
+                         ChannelOrder order = ChannelOrder::BGR);
+cv::Mat preprocess_batch(const std::vector<cv::Mat>& frames, Letterbox::InputTensor& input,
+                         ChannelOrder order = ChannelOrder::BGR);
+BallDetections decode_detections(const std::vector<cv::Mat>& outputs, const cv::Size& frame_size,
+                                 int input_size = Config::MODEL_INPUT_SIZE);
+
+/**
+ * @brief Ghép các blob [1, 3, H, W] của preprocess_frame thành 1 blob [N, 3, H, W]
+ * @param buffer Bộ nhớ của blob ghép, dùng lại giữa các batch (chỉ cấp phát khi đổi kích thước)
+ * @return blobs[0] nếu chỉ có 1 blob, ngược lại buffer
+ */
+cv::Mat stack_blobs(const std::vector<cv::Mat>& blobs, cv::Mat& buffer);
+
+/**
+ * @brief Vẽ kết quả của track_ball lên frame (tại chỗ)
+ * @param detailed false: bỏ line sân và góc (tốn nhất), chỉ vẽ trail + bounce
+ */
+void annotate_frame(cv::Mat& frame, const FrameResult& result, bool detailed = true);
@@ -16,10 +16,6 @@ namespace BallTracking {
     const double MIN_SPEED = 2.0;        // Vận tốc tối thiểu để coi là bóng đang di chuyển
     const int RECENT_POSITIONS_COUNT = 5; // Số vị trí gần đây để tính vận tốc
 
-    // Biến toàn cục quản lý tracking
-    static std::map<int, TrackedObj> tracking_objects;
-    static int next_id = 0;
-
     // Hàm tính kích thước từ Rect (diện tích)
     static float calculate_size(const cv::Rect& rect) {
         return static_cast<float>(rect.width * rect.height);
@@ -37,7 +33,56 @@ namespace BallTracking {
         return total_dist / (positions.size() - 1);
     }
 
-    std::optional<cv::Point> try_get_main_ball(
+    void LocalSearch::set_template(const cv::Mat& frame, const cv::Rect& box) {
+        cv::Rect clipped = box & cv::Rect(0, 0, frame.cols, frame.rows);
+        // Box quá nhỏ (bóng ở xa / bị cắt ở mép) -> template không đủ chi tiết để match
+        if (clipped.width < 4 || clipped.height < 4) {
+            templ.release();
+            return;
+        }
+        if (frame.channels() == 3) {
+            cv::cvtColor(frame(clipped), templ, gray_code);
+        } else {
+            templ = frame(clipped).clone();
+        }
+    }
+
+    std::optional<LocalMatch> LocalSearch::search(const cv::Mat& frame, const cv::Point2f& predicted, int radius) const {
+        if (templ.empty()) {
+            return std::nullopt;
+        }
+        // Chỉ chuyển grayscale vùng tìm (vài chục pixel), không phải cả frame
+        cv::Rect window(cvRound(predicted.x) - templ.cols / 2 - radius, cvRound(predicted.y) - templ.rows / 2 - radius,
+                        templ.cols + 2 * radius, templ.rows + 2 * radius);
+        window &= cv::Rect(0, 0, frame.cols, frame.rows);
+        if (window.width < templ.cols || window.height < templ.rows) {
+            return std::nullopt;
+        }
+        cv::Mat gray;
+        if (frame.channels() == 3) {
+            cv::cvtColor(frame(window), gray, gray_code);
+        } else {
+            gray = frame(window);
+        }
+
+        cv::Mat response;
+        cv::matchTemplate(gray, templ, response, cv::TM_CCOEFF_NORMED);
+        double max_score;
+        cv::Point max_loc;
+        cv::minMaxLoc(response, nullptr, &max_score, nullptr, &max_loc);
+
+        LocalMatch match;
+        match.box = cv::Rect(window.x + max_loc.x, window.y + max_loc.y, templ.cols, templ.rows);
+        match.score = static_cast<float>(max_score);
+        return match;
+    }
+
+    void Tracker::reset() {
+        tracking_objects.clear();
+        next_id = 0;
+    }
+
+    std::optional<cv::Point> Tracker::try_get_main_ball(
         const std::vector<cv::Rect>& detections, 
         const std::vector<float>& confidences
     ) {
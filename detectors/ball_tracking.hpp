@@ -4,6 +4,7 @@
 #include <vector>
 #include <deque>
 #include <optional>
+#include "../utils/channel_order.hpp"
 
 namespace BallTracking {
     struct TrackedObj {
@@ -16,10 +17,65 @@ namespace BallTracking {
         double recent_speed;  // Vận tốc trung bình gần đây
     };
 
-    // Hàm chính: nhận vào danh sách detection và confidence scores từ YOLO
-    // Trả về tọa độ bóng chính (nếu có)
-    std::optional<cv::Point> try_get_main_ball(
-        const std::vector<cv::Rect>& detections, 
-        const std::vector<float>& confidences
-    );
+    /**
+     * @brief Kết quả tìm bóng cục bộ quanh vị trí dự đoán
+     */
+    struct LocalMatch {
+        cv::Rect box;
+        float score = 0.0f;  // TM_CCOEFF_NORMED (1 = giống hệt template)
+    };
+
+    /**
+     * @brief Tìm lại bóng quanh vị trí Kalman dự đoán bằng template matching (thay YOLO ở frame bỏ inference)
+     * Template chỉ lấy từ box của YOLO, không cập nhật theo kết quả tìm cục bộ -> không bị trôi dần.
+     */
+    class LocalSearch {
+    public:
+        /**
+         * @brief Lấy template (grayscale) từ box bóng YOLO vừa tìm được
+         */
+        void set_template(const cv::Mat& frame, const cv::Rect& box);
+        bool has_template() const { return !templ.empty(); }
+        void clear() { templ.release(); }
+
+        /**
+         * @brief Thứ tự kênh của frame đưa vào (đổi grayscale đúng trọng số R / B)
+         */
+        void set_channel_order(ChannelOrder order) {
+            gray_code = order == ChannelOrder::RGB ? cv::COLOR_RGB2GRAY : cv::COLOR_BGR2GRAY;
+        }
+
+        /**
+         * @param predicted Tâm bóng dự đoán
+         * @param radius Bán kính tìm quanh tâm dự đoán (pixel)
+         * @return std::nullopt nếu chưa có template hoặc vùng tìm nằm ngoài frame
+         */
+        std::optional<LocalMatch> search(const cv::Mat& frame, const cv::Point2f& predicted, int radius) const;
+
+    private:
+        cv::Mat templ;
+        int gray_code = cv::COLOR_BGR2GRAY;
+    };
+
+    /**
+     * @brief Trạng thái tracking của 1 video (mỗi DetectorSession có 1 Tracker riêng)
+     */
+    class Tracker {
+    public:
+        // Hàm chính: nhận vào danh sách detection và confidence scores từ YOLO
+        // Trả về tọa độ bóng chính (nếu có)
+        std::optional<cv::Point> try_get_main_ball(
+            const std::vector<cv::Rect>& detections, 
+            const std::vector<float>& confidences
+        );
+
+        /**
+         * @brief Xóa mọi object đang track (bắt đầu video mới)
+         */
+        void reset();
+
+    private:
+        std::map<int, TrackedObj> tracking_objects;
+        int next_id = 0;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "inference_backend.hpp"
+#include "opencv_backend.hpp"
+#ifdef HAVE_ONNXRUNTIME
+#include "onnxruntime_backend.hpp"
+#endif
+#include "../utils/letterbox.hpp"
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+namespace {
+    // Blob calibration (đọc + letterbox toàn bộ ảnh) chỉ làm 1 lần mỗi process; Net INT8 thì mỗi
+    // engine tự lượng tử hóa vì OpenCV không copy được Net đã lượng tử hóa
+    std::once_flag calibration_once;
+    std::vector<cv::Mat> calibration_blobs;
+
+    const std::vector<cv::Mat>& cached_calibration_blobs() {
+        // Không đọc được ảnh -> exception, once_flag chưa đánh dấu, lần tạo engine sau thử lại
+        std::call_once(calibration_once, [] {
+            std::vector<cv::Mat> blobs = loadCalibrationBlobs(Config::INT8_CALIBRATION_DIR);
+            if (blobs.empty()) {
+                CV_Error(cv::Error::StsError, "Không đọc được ảnh calibration trong " + Config::INT8_CALIBRATION_DIR);
+            }
+            calibration_blobs = std::move(blobs);
+        });
+        return calibration_blobs;
+    }
+}
+
+uint64_t modelContentHash(const std::vector<uchar>& onnx_bytes) {
+    uint64_t hash = 14695981039346656037ULL;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= onnx_bytes.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, onnx_bytes.data() + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ULL;
+    }
+    for (; i < onnx_bytes.size(); i++) {
+        hash = (hash ^ onnx_bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::unique_ptr<InferenceBackend> createInferenceBackend(const std::string& backend,
+                                                         const std::vector<uchar>& onnx_bytes,
+                                                         int threads,
+                                                         const std::string& cache_path) {
+    if (backend == "opencv") {
+        return std::make_unique<OpenCVDnnBackend>(onnx_bytes, OpenCVDnnBackend::Mode::Default);
+    }
+    if (backend == "opencv-int8") {
+        std::vector<cv::String> calibration_files;
+        cv::glob(Config::INT8_CALIBRATION_DIR + "/*.png", calibration_files, false);
+        if (calibration_files.empty()) {
+            std::cerr << "[ERROR] Không có ảnh calibration trong " << Config::INT8_CALIBRATION_DIR
+                      << ", hãy chạy tools/calibrate_int8 trước" << std::endl;
+            return nullptr;
+        }
+        const std::vector<cv::Mat>& calibration = cached_calibration_blobs();
+        auto start = std::chrono::steady_clock::now();
+        auto engine = std::make_unique<OpenCVDnnBackend>(onnx_bytes, calibration);
+        std::cout << "[INFO] Lượng tử hóa INT8 (" << calibration.size() << " ảnh calibration): "
+                  << cv::format("%.0f", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count())
+                  << "ms" << std::endl;
+        return engine;
+    }
+    if (backend == "openvino") {
+        if (!OpenCVDnnBackend::openvinoAvailable()) {
+            std::cerr << "[ERROR] OpenCV không được build với OpenVINO (Inference Engine), hãy dùng backend khác" << std::endl;
+            return nullptr;
+        }
+        return std::make_unique<OpenCVDnnBackend>(onnx_bytes, OpenCVDnnBackend::Mode::OpenVINO);
+    }
+    if (backend == "onnxruntime") {
+#ifdef HAVE_ONNXRUNTIME
+        return std::make_unique<OnnxRuntimeBackend>(onnx_bytes, threads, cache_path);
+#else
+        std::cerr << "[ERROR] Bản build này không có ONNX Runtime, hãy dùng backend khác (opencv/openvino)" << std::endl;
+        return nullptr;
+#endif
+    }
+    std::cerr << "[ERROR] Không có inference backend: " << backend << std::endl;
+    return nullptr;
+}
+
+std::vector<std::string> availableInferenceBackends() {
+    std::vector<std::string> backends = { "opencv" };
+    if (OpenCVDnnBackend::openvinoAvailable()) {
+        backends.push_back("openvino");
+    }
+    std::vector<cv::String> calibration_files;
+    cv::glob(Config::INT8_CALIBRATION_DIR + "/*.png", calibration_files, false);
+    if (!calibration_files.empty()) {
+        backends.push_back("opencv-int8");
+    }
+#ifdef HAVE_ONNXRUNTIME
+    backends.push_back("onnxruntime");
+#endif
+    return backends;
+}
+
+std::vector<cv::Mat> loadCalibrationBlobs(const std::string& dir, int input_size) {
+    std::vector<cv::String> files;
+    cv::glob(dir + "/*.png", files, false);
+    std::vector<cv::Mat> blobs;
+    Letterbox::InputTensor input;
+    for (const cv::String& file : files) {
+        cv::Mat image = cv::imread(file, cv::IMREAD_COLOR);
+        if (image.empty()) {
+            std::cerr << "[WARNING] Không đọc được ảnh calibration: " << file << std::endl;
+            continue;
+        }
+        input.fill(image, input_size);
+        blobs.push_back(input.blob().clone());
+    }
+    return blobs;
+}
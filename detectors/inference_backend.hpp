@@ -0,0 +1,65 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "../config.hpp"
+
+/**
+ * @brief Interface chung cho engine chạy model ONNX (OpenCV DNN, OpenVINO qua OpenCV, ONNX Runtime)
+ *
+ * Mỗi instance giữ graph / state riêng, không thread-safe (mỗi DetectorSession 1 instance).
+ * Lỗi khi forward (shape không hỗ trợ...) ném cv::Exception ở mọi backend, để các chỗ
+ * fallback (batch cố định, input size cố định) xử lý giống nhau.
+ */
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    /**
+     * @brief blob [N, 3, H, W] float32 -> các output của model (caller sở hữu, không trỏ vào engine)
+     */
+    virtual std::vector<cv::Mat> forward(const cv::Mat& blob) = 0;
+
+    /**
+     * @brief Tên backend (như tham số --backend=) kèm target thực tế, ví dụ "opencv (CUDA)"
+     */
+    virtual std::string name() const = 0;
+};
+
+/**
+ * @brief Tạo backend từ bytes ONNX
+ * @param backend "opencv" (CPU, CUDA nếu có GPU), "openvino" (OpenCV build với Inference Engine),
+ *                "opencv-int8" (lượng tử hóa bằng ảnh trong Config::INT8_CALIBRATION_DIR; ảnh đọc 1 lần
+ *                mỗi process, mỗi engine lượng tử hóa Net riêng -> engine forward song song được)
+ *                hoặc "onnxruntime" (build với HAVE_ONNXRUNTIME)
+ * @param threads Số thread trong 1 lần forward (ONNX Runtime); 0 = mặc định của engine.
+ *                OpenCV DNN dùng thread pool chung của process (cv::setNumThreads)
+ * @param cache_path Tiền tố file cache graph đã tối ưu (không có đuôi, "" = không cache). Backend
+ *                   tự thêm đuôi riêng; hiện chỉ ONNX Runtime lưu được graph (OpenCV DNN không
+ *                   serialize Net sau khi tối ưu / lượng tử hóa)
+ * @return nullptr nếu backend không có trong bản build này (đã in [ERROR]);
+ *         ném cv::Exception nếu không parse được model
+ */
+std::unique_ptr<InferenceBackend> createInferenceBackend(const std::string& backend,
+                                                         const std::vector<uchar>& onnx_bytes,
+                                                         int threads = 0,
+                                                         const std::string& cache_path = std::string());
+
+/**
+ * @brief Các backend dùng được trong bản build / máy hiện tại
+ * ("opencv-int8" chỉ có khi đã có ảnh calibration)
+ */
+std::vector<std::string> availableInferenceBackends();
+
+/**
+ * @brief FNV-1a 64-bit trên nội dung model (đổi model -> đổi tên file cache)
+ */
+uint64_t modelContentHash(const std::vector<uchar>& onnx_bytes);
+
+/**
+ * @brief Đọc ảnh calibration (*.png trong dir, đã letterbox) thành blob [1, 3, S, S]
+ */
+std::vector<cv::Mat> loadCalibrationBlobs(const std::string& dir, int input_size = Config::MODEL_INPUT_SIZE);
@@ -1,28 +1,46 @@
 #include "line_detector.hpp"
 #include "../config.hpp"
-#include "../utils/vlc_reader.hpp"
+#include "../utils/frame_source.hpp"
 #include <iostream>
 #include <cmath>
 #include <vector>
+#include <mutex>
 
 namespace LineDetector {
 
-    void execute(int cx, int cy, cv::Mat& frame) {
+    CourtLines::CourtLines()
+        : source_backend(Config::FRAME_SOURCE)
+        , source_path(Config::SOURCE_VIDEO_PATH)
+    {
+    }
+
+    void CourtLines::configure_source(const std::string& backend, const std::string& path) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        source_backend = backend;
+        source_path = path;
+        lines_cached = false;
+        cached_lines.clear();
+        cached_size = cv::Size();
+    }
+
+    // Tìm các line biên sân trên frame đầu tiên của nguồn
+    static bool find_court_lines(const std::string& source_backend, const std::string& source_path,
+                                 std::vector<cv::Vec4i>& filtered_lines, cv::Size& image_size) {
         // 1. Đọc frame đầu tiên của video để tìm line (Giống logic Python)
-        // Sử dụng VLC để đọc video
-        VLCVideoReader cap;
-        if (!cap.open(Config::SOURCE_VIDEO_PATH)) {
+        std::unique_ptr<FrameSource> cap = createFrameSource(source_backend);
+        if (!cap || !cap->open(source_path)) {
             std::cerr << "[LineDetector] Không mở được video để tìm line!" << std::endl;
-            return;
+            return false;
         }
         cv::Mat img;
-        if (!cap.read(img)) { // Đọc 1 frame
-            cap.release();
-            return;
+        if (!cap->read(img)) { // Đọc 1 frame
+            cap->release();
+            return false;
         }
-        cap.release();
+        cap->release();
 
-        if (img.empty()) return;
+        if (img.empty()) return false;
+        image_size = img.size();
 
         // 2. Xử lý ảnh tìm Line (Màu trắng)
         cv::Mat hsv, mask;
@@ -42,7 +60,7 @@ namespace LineDetector {
         cv::HoughLinesP(mask, lines, 1, CV_PI/180, 50, 50, 10);
 
         // Lọc line theo góc (80 - 85 độ)
-        std::vector<cv::Vec4i> filtered_lines;
+        filtered_lines.clear();
         for (const auto& l : lines) {
             double dx = l[2] - l[0];
             double dy = l[3] - l[1];
@@ -53,18 +71,37 @@ namespace LineDetector {
                 filtered_lines.push_back(l);
             }
         }
+        return true;
+    }
 
-        // Vẽ line tìm được lên frame hiện tại
-        for (const auto& l : filtered_lines) {
-            cv::line(frame, cv::Point(l[0], l[1]), cv::Point(l[2], l[3]), cv::Scalar(0, 255, 0), 2);
+    std::optional<LineCheck> CourtLines::check(int cx, int cy, const cv::Size& frame_size) {
+        LineCheck result;
+        result.point = cv::Point(cx, cy);
+        cv::Size reference_size;
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (!lines_cached) {
+                // Không cache khi đọc lỗi để lần bounce sau thử lại (giống hành vi cũ)
+                if (!find_court_lines(source_backend, source_path, cached_lines, cached_size)) return std::nullopt;
+                lines_cached = true;
+            }
+            result.lines = cached_lines;
+            reference_size = cached_size;
         }
 
-        // 4. Kiểm tra In/Out (Chỉ lấy line đầu tiên tìm được)
-        std::string status = "Out";
-        cv::Scalar color(0, 0, 255); // Red
+        // Frame đang xử lý có thể đã được scale khi decode (chỉ detect, không ghi video)
+        // -> đưa line về cùng hệ tọa độ với frame
+        if (!reference_size.empty() && frame_size != reference_size) {
+            double sx = (double)frame_size.width / reference_size.width;
+            double sy = (double)frame_size.height / reference_size.height;
+            for (auto& l : result.lines) {
+                l = cv::Vec4i(cvRound(l[0] * sx), cvRound(l[1] * sy), cvRound(l[2] * sx), cvRound(l[3] * sy));
+            }
+        }
 
-        if (!filtered_lines.empty()) {
-            cv::Vec4i line = filtered_lines[0];
+        // 4. Kiểm tra In/Out (Chỉ lấy line đầu tiên tìm được)
+        if (!result.lines.empty()) {
+            cv::Vec4i line = result.lines[0];
             cv::Point pt1(line[0], line[1]);
             cv::Point pt2(line[2], line[3]);
 
@@ -75,15 +112,32 @@ namespace LineDetector {
             double value = (cx - pt1.x) * dy - (cy - pt1.y) * dx;
 
             // Python: value > 0 là In (tùy thuộc hệ trục, giả sử theo code gốc)
-            if (value > 0) {
-                status = "In";
-                color = cv::Scalar(0, 255, 0); // Green
-            }
+            result.in = value > 0;
         }
+        return result;
+    }
+
+    void draw(const LineCheck& result, cv::Mat& frame) {
+        // Vẽ line tìm được lên frame hiện tại
+        for (const auto& l : result.lines) {
+            cv::line(frame, cv::Point(l[0], l[1]), cv::Point(l[2], l[3]), cv::Scalar(0, 255, 0), 2);
+        }
+
+        std::string status = result.in ? "In" : "Out";
+        cv::Scalar color = result.in ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255); // Green / Red
 
         // Vẽ kết quả
+        int cx = result.point.x;
+        int cy = result.point.y;
         cv::putText(frame, status, cv::Point(cx - 20, cy - 20), 
                     cv::FONT_HERSHEY_SIMPLEX, 1.0, color, 3);
         cv::circle(frame, cv::Point(cx, cy), 10, color, -1);
     }
-}
\ No newline at end of file
+
+    void execute(CourtLines& court, int cx, int cy, cv::Mat& frame) {
+        std::optional<LineCheck> result = court.check(cx, cy, frame.size());
+        if (result.has_value()) {
+            draw(result.value(), frame);
+        }
+    }
+}
@@ -1,13 +1,67 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <vector>
+#include <optional>
+#include <mutex>
 
 namespace LineDetector {
     /**
-     * @brief Kiểm tra bóng In hay Out khi có va chạm
+     * @brief Kết quả kiểm tra In/Out tại 1 điểm nảy (line đã ở hệ tọa độ của frame)
+     */
+    struct LineCheck {
+        cv::Point point;
+        bool in = false;
+        std::vector<cv::Vec4i> lines;
+    };
+
+    /**
+     * @brief Line biên sân của 1 video (mỗi DetectorSession có 1 CourtLines riêng)
+     * 
+     * Line chỉ phụ thuộc frame đầu tiên của nguồn -> tính 1 lần (lần bounce đầu tiên)
+     * rồi dùng lại cho mọi bounce sau. Thread-safe.
+     */
+    class CourtLines {
+    public:
+        /**
+         * @brief Mặc định: Config::FRAME_SOURCE với Config::SOURCE_VIDEO_PATH
+         */
+        CourtLines();
+
+        /**
+         * @brief Chọn nguồn frame để lấy ảnh tham chiếu tìm line
+         * @param backend Tên backend của createFrameSource
+         * @param path Đường dẫn / spec truyền cho FrameSource::open
+         */
+        void configure_source(const std::string& backend, const std::string& path);
+
+        /**
+         * @brief Kiểm tra bóng In hay Out, không vẽ gì (dùng được trước khi có frame để vẽ)
+         * @param frame_size Kích thước frame chứa (cx, cy)
+         * @return std::nullopt nếu không tìm được line sân
+         */
+        std::optional<LineCheck> check(int cx, int cy, const cv::Size& frame_size);
+
+    private:
+        std::mutex cache_mutex;
+        std::string source_backend;
+        std::string source_path;
+        bool lines_cached = false;
+        std::vector<cv::Vec4i> cached_lines;
+        cv::Size cached_size;  // Kích thước frame tham chiếu (full-res) mà line được tìm trên đó
+    };
+
+    /**
+     * @brief Vẽ line sân và kết quả In/Out lên frame
+     */
+    void draw(const LineCheck& result, cv::Mat& frame);
+
+    /**
+     * @brief Kiểm tra bóng In hay Out khi có va chạm (check + draw)
+     * @param court Line sân của video đang xử lý
      * @param cx Tọa độ x bóng
      * @param cy Tọa độ y bóng
      * @param frame Ảnh frame hiện tại (để vẽ kết quả lên)
      */
-    void execute(int cx, int cy, cv::Mat& frame);
+    void execute(CourtLines& court, int cx, int cy, cv::Mat& frame);
 }
\ No newline at end of file
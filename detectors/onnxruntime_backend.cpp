@@ -0,0 +1,118 @@
+#include "onnxruntime_backend.hpp"
+#include <opencv2/core/utils/filesystem.hpp>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+namespace {
+    // 1 Ort::Env cho cả process (giữ thread pool / logger dùng chung giữa các session)
+    Ort::Env& ort_env() {
+        static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "pickleball");
+        return env;
+    }
+
+    Ort::SessionOptions make_options(GraphOptimizationLevel level, int threads) {
+        Ort::SessionOptions options;
+        options.SetGraphOptimizationLevel(level);
+        if (threads > 0) {
+            options.SetIntraOpNumThreads(threads);
+        }
+        return options;
+    }
+
+    std::vector<uchar> read_file(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uchar>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+}
+
+OnnxRuntimeBackend::OnnxRuntimeBackend(const std::vector<uchar>& onnx_bytes, int threads, const std::string& cache_path) {
+    // Graph tối ưu ở định dạng nội bộ của ONNX Runtime -> tên file gắn với phiên bản API
+    const std::string cache_file = cache_path.empty() ? std::string()
+                                                      : cache_path + ".ort" + std::to_string(ORT_API_VERSION) + ".onnx";
+    try {
+        bool loaded = false;
+        std::vector<uchar> cached = cache_file.empty() ? std::vector<uchar>() : read_file(cache_file);
+        if (!cached.empty()) {
+            try {
+                // Graph trong cache đã qua mọi bước tối ưu -> không chạy lại
+                session_ = Ort::Session(ort_env(), cached.data(), cached.size(),
+                                        make_options(GraphOptimizationLevel::ORT_DISABLE_ALL, threads));
+                loaded = true;
+                std::cout << "[INFO] ONNX Runtime: dùng graph đã tối ưu trong cache " << cache_file << std::endl;
+            } catch (const Ort::Exception& e) {
+                std::cerr << "[WARNING] ONNX Runtime: không load được cache " << cache_file << " (" << e.what()
+                          << "), tối ưu lại từ model gốc" << std::endl;
+            }
+        }
+        if (!loaded) {
+            Ort::SessionOptions options = make_options(GraphOptimizationLevel::ORT_ENABLE_ALL, threads);
+            std::string temp_file;
+            if (!cache_file.empty() && cv::utils::fs::createDirectories(cv::utils::fs::getParent(cache_file))) {
+                // Ghi file tạm rồi đổi tên -> session khác / lần chạy sau không đọc phải file dở dang
+                temp_file = cache_file + ".tmp";
+#ifdef _WIN32
+                std::wstring temp_path(temp_file.begin(), temp_file.end());
+                options.SetOptimizedModelFilePath(temp_path.c_str());
+#else
+                options.SetOptimizedModelFilePath(temp_file.c_str());
+#endif
+            }
+            session_ = Ort::Session(ort_env(), onnx_bytes.data(), onnx_bytes.size(), options);
+            if (!temp_file.empty()) {
+                std::remove(cache_file.c_str());
+                if (std::rename(temp_file.c_str(), cache_file.c_str()) == 0) {
+                    std::cout << "[INFO] ONNX Runtime: đã lưu graph tối ưu vào " << cache_file << std::endl;
+                } else {
+                    std::remove(temp_file.c_str());
+                    std::cerr << "[WARNING] ONNX Runtime: không ghi được cache " << cache_file << std::endl;
+                }
+            }
+        }
+        memory_info_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        for (size_t i = 0; i < session_.GetInputCount(); i++) {
+            input_names_.push_back(session_.GetInputNameAllocated(i, allocator).get());
+        }
+        for (size_t i = 0; i < session_.GetOutputCount(); i++) {
+            output_names_.push_back(session_.GetOutputNameAllocated(i, allocator).get());
+        }
+    } catch (const Ort::Exception& e) {
+        CV_Error(cv::Error::StsError, std::string("ONNX Runtime: ") + e.what());
+    }
+    name_ = threads > 0 ? "onnxruntime (CPU, " + std::to_string(threads) + " thread)" : "onnxruntime (CPU)";
+}
+
+std::vector<cv::Mat> OnnxRuntimeBackend::forward(const cv::Mat& blob) {
+    cv::Mat input = blob.isContinuous() ? blob : blob.clone();
+    std::vector<int64_t> shape(input.size.p, input.size.p + input.dims);
+
+    std::vector<const char*> input_names;
+    for (const std::string& name : input_names_) {
+        input_names.push_back(name.c_str());
+    }
+    std::vector<const char*> output_names;
+    for (const std::string& name : output_names_) {
+        output_names.push_back(name.c_str());
+    }
+
+    std::vector<cv::Mat> outputs;
+    try {
+        Ort::Value tensor = Ort::Value::CreateTensor<float>(memory_info_, input.ptr<float>(), input.total(),
+                                                            shape.data(), shape.size());
+        std::vector<Ort::Value> results = session_.Run(Ort::RunOptions{nullptr}, input_names.data(), &tensor, 1,
+                                                       output_names.data(), output_names.size());
+        for (Ort::Value& result : results) {
+            std::vector<int64_t> dims = result.GetTensorTypeAndShapeInfo().GetShape();
+            std::vector<int> sizes(dims.begin(), dims.end());
+            cv::Mat view(static_cast<int>(sizes.size()), sizes.data(), CV_32F, result.GetTensorMutableData<float>());
+            outputs.push_back(view.clone());
+        }
+    } catch (const Ort::Exception& e) {
+        // Cùng loại lỗi với OpenCV DNN -> fallback batch / input size hoạt động như nhau
+        CV_Error(cv::Error::StsError, std::string("ONNX Runtime: ") + e.what());
+    }
+    return outputs;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "inference_backend.hpp"
+#include <onnxruntime_cxx_api.h>
+
+/**
+ * @brief ONNX Runtime trên CPU (chỉ có khi build với HAVE_ONNXRUNTIME)
+ *
+ * Graph được tối ưu đầy đủ (ORT_ENABLE_ALL) khi tạo session. Có cache_path: graph đã tối ưu được
+ * ghi ra <cache_path>.ort<API>.onnx, lần sau load file đó và tắt bước tối ưu (file hỏng / khác
+ * phiên bản -> tối ưu lại từ model gốc và ghi đè). Input truyền thẳng bộ nhớ của blob (không copy),
+ * output copy ra cv::Mat vì Ort::Value giải phóng sau mỗi lần Run.
+ */
+class OnnxRuntimeBackend : public InferenceBackend {
+public:
+    /**
+     * @param threads Số thread intra-op (0 = mặc định của ONNX Runtime, theo số core vật lý)
+     * @param cache_path Tiền tố file cache graph đã tối ưu ("" = không cache)
+     */
+    OnnxRuntimeBackend(const std::vector<uchar>& onnx_bytes, int threads, const std::string& cache_path = std::string());
+
+    std::vector<cv::Mat> forward(const cv::Mat& blob) override;
+    std::string name() const override { return name_; }
+
+private:
+    Ort::Session session_{nullptr};
+    Ort::MemoryInfo memory_info_{nullptr};
+    std::vector<std::string> input_names_;
+    std::vector<std::string> output_names_;
+    std::string name_;
+};
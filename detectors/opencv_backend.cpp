@@ -0,0 +1,48 @@
+#include "opencv_backend.hpp"
+
+OpenCVDnnBackend::OpenCVDnnBackend(const std::vector<uchar>& onnx_bytes, Mode mode) {
+    net_ = cv::dnn::readNetFromONNX(onnx_bytes);
+    if (net_.empty()) {
+        CV_Error(cv::Error::StsError, "Không thể load model ONNX (net.empty())");
+    }
+    if (mode == Mode::OpenVINO) {
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        name_ = "openvino (CPU)";
+    } else if (cv::cuda::getCudaEnabledDeviceCount() > 0) {
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+        name_ = "opencv (CUDA)";
+    } else {
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        name_ = "opencv (CPU)";
+    }
+    output_names_ = net_.getUnconnectedOutLayersNames();
+}
+
+OpenCVDnnBackend::OpenCVDnnBackend(const std::vector<uchar>& onnx_bytes, const std::vector<cv::Mat>& calibration)
+    : name_("opencv-int8 (CPU)") {
+    cv::dnn::Net net = cv::dnn::readNetFromONNX(onnx_bytes);
+    if (net.empty()) {
+        CV_Error(cv::Error::StsError, "Không thể load model ONNX (net.empty())");
+    }
+    // Net lượng tử hóa chỉ chạy trên backend OpenCV / CPU
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    net_ = net.quantize(calibration, CV_32F, CV_32F);
+    net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    output_names_ = net_.getUnconnectedOutLayersNames();
+}
+
+std::vector<cv::Mat> OpenCVDnnBackend::forward(const cv::Mat& blob) {
+    std::vector<cv::Mat> outputs;
+    net_.setInput(blob);
+    net_.forward(outputs, output_names_);
+    return outputs;
+}
+
+bool OpenCVDnnBackend::openvinoAvailable() {
+    return !cv::dnn::getAvailableTargets(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE).empty();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "inference_backend.hpp"
+
+/**
+ * @brief cv::dnn::Net (backend mặc định)
+ *
+ * "opencv": DNN_BACKEND_OPENCV trên CPU, tự chuyển CUDA khi có GPU (như trước).
+ * "openvino": DNN_BACKEND_INFERENCE_ENGINE trên CPU, cần OpenCV build với OpenVINO.
+ * "opencv-int8": Net FP32 lượng tử hóa INT8 (per-channel) bằng blob calibration, chạy
+ * DNN_BACKEND_OPENCV trên CPU. Input / output vẫn là float32.
+ */
+class OpenCVDnnBackend : public InferenceBackend {
+public:
+    enum class Mode {
+        Default,
+        OpenVINO,
+    };
+
+    OpenCVDnnBackend(const std::vector<uchar>& onnx_bytes, Mode mode);
+
+    /**
+     * @brief Engine "opencv-int8": lượng tử hóa Net riêng của engine từ model FP32
+     *
+     * OpenCV DNN không serialize / copy được Net sau khi lượng tử hóa -> mỗi engine tự lượng tử hóa
+     * (blob calibration dùng chung), các engine forward song song không phải chờ nhau.
+     * @param calibration Blob [1, 3, S, S] đã letterbox
+     */
+    OpenCVDnnBackend(const std::vector<uchar>& onnx_bytes, const std::vector<cv::Mat>& calibration);
+
+    std::vector<cv::Mat> forward(const cv::Mat& blob) override;
+    std::string name() const override { return name_; }
+
+    /**
+     * @brief OpenCV hiện tại có được build với OpenVINO (Inference Engine) không
+     */
+    static bool openvinoAvailable();
+
+private:
+    cv::dnn::Net net_;
+    std::vector<std::string> output_names_;
+    std::string name_;
+};
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <algorithm>
 #include <opencv2/opencv.hpp>
 
 // Include file cấu hình mới
@@ -8,34 +12,188 @@
 // Include file header của detector
 #include "detectors/ball_detector.hpp"
 
-// Include VLC video reader
-#include "utils/vlc_reader.hpp" 
+// Include nguồn frame (VLC / OpenCV / thư mục ảnh / giả lập)
+#include "utils/frame_source.hpp"
+#include "utils/frame_pipeline.hpp"
+#include "utils/segment_runner.hpp"
+#include "utils/quality_controller.hpp"
+#include "utils/metrics.hpp"
+#include "utils/async_video_writer.hpp"
+#include "detectors/line_detector.hpp"
+#ifdef HAVE_LIBVLC
+#include "utils/vlc_reader.hpp"
+#endif
+
+int main(int argc, char** argv) {
+    auto program_start = std::chrono::steady_clock::now();
+
+    // Tham số dòng lệnh (ghi đè config.hpp)
+    //   --source=vlc|opencv|images|synthetic   --input=<video / thư mục ảnh / spec giả lập>
+    //   --offline / --paced (chỉ VLC)   --no-output / --output (ghi video annotation hay không)
+    //   --drop=oldest|latest|block|auto (chỉ VLC: xử lý chậm hơn nguồn thì bỏ frame nào)
+    //   --pipeline / --sequential (mỗi stage 1 thread hay vòng lặp tuần tự cũ)
+    //   --batch=N (số frame mỗi lần forward, áp dụng cho pipeline và chia đoạn)
+    //   --segments=N (chia 1 video thành N đoạn xử lý song song, cần file seek được)
+    //   --target-fps=N (tự hạ / nâng chất lượng để giữ N fps, 0 = tắt)
+    //   --skip=N (đang bám bóng: YOLO 1 trên N frame, còn lại Kalman + tìm cục bộ; chạy tuần tự)
+    //   --backend=opencv|openvino|opencv-int8|onnxruntime (engine chạy model)
+    //   --model=<file.onnx> (ví dụ model INT8 QDQ / FP16 đã lượng tử hóa sẵn)
+    //   --warmup=N (số lần forward giả trước frame đầu tiên, 0 = tắt)
+    //   --roi / --no-roi (đang bám bóng: YOLO chỉ chạy trên vùng quanh bóng; chạy tuần tự)
+    //   --metrics=<path> --metrics-interval=<giây> --no-metrics (histogram độ trễ -> path.json/.csv)
+    //   --codec=mp4v|h264|mjpg --preset=<preset H.264> --quality=<0-100, MJPEG>
+    //
+    // Camera live: --input=rtsp://... (hoặc udp://, http://), mặc định chạy paced.
+    // Thử trên 1 máy bằng VLC phát file qua loopback:
+    //   cvlc data/in.mp4 --loop --sout '#rtp{sdp=rtsp://127.0.0.1:8554/court}'
+    //   run_app --input=rtsp://127.0.0.1:8554/court --drop=latest --no-output
+    FrameSourceOptions source_options;
+    source_options.offline_decode = Config::VLC_OFFLINE_DECODE;
+    source_options.drop_policy = Config::VLC_DROP_POLICY;
+    bool decode_mode_set = false;
+    bool use_pipeline = Config::PIPELINE_ENABLED;
+    int batch_size = Config::INFERENCE_BATCH_SIZE;
+    int segments = Config::SEGMENT_COUNT;
+    double target_fps = Config::QUALITY_TARGET_FPS;
+    int skip_stride = Config::INFERENCE_SKIP_STRIDE;
+    bool use_roi = Config::ROI_INFERENCE;
+    std::string inference_backend = Config::INFERENCE_BACKEND;
+    std::string model_path = Config::MODEL_PATH;
+    int warmup_runs = Config::MODEL_WARMUP_RUNS;
+    bool metrics_enabled = Config::METRICS_ENABLED;
+    std::string metrics_path = Config::METRICS_PATH;
+    double metrics_interval = Config::METRICS_INTERVAL_S;
+    AsyncVideoWriter::Options writer_options;
+    writer_options.codec = Config::OUTPUT_CODEC;
+    writer_options.preset = Config::OUTPUT_H264_PRESET;
+    writer_options.quality = Config::OUTPUT_QUALITY;
+    writer_options.queue_capacity = Config::OUTPUT_QUEUE_CAPACITY;
+    bool write_output = Config::WRITE_OUTPUT_VIDEO;
+    std::string source_backend = Config::FRAME_SOURCE;
+    std::string source_input;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--offline") == 0) {
+            source_options.offline_decode = true;
+            decode_mode_set = true;
+        } else if (std::strcmp(argv[i], "--paced") == 0) {
+            source_options.offline_decode = false;
+            decode_mode_set = true;
+        } else if (std::strcmp(argv[i], "--pipeline") == 0) {
+            use_pipeline = true;
+        } else if (std::strcmp(argv[i], "--sequential") == 0) {
+            use_pipeline = false;
+        } else if (std::strncmp(argv[i], "--batch=", 8) == 0) {
+            batch_size = std::max(1, std::atoi(argv[i] + 8));
+        } else if (std::strncmp(argv[i], "--segments=", 11) == 0) {
+            segments = std::max(1, std::atoi(argv[i] + 11));
+        } else if (std::strncmp(argv[i], "--target-fps=", 13) == 0) {
+            target_fps = std::max(0.0, std::atof(argv[i] + 13));
+        } else if (std::strncmp(argv[i], "--model=", 8) == 0) {
+            model_path = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--warmup=", 9) == 0) {
+            warmup_runs = std::max(0, std::atoi(argv[i] + 9));
+        } else if (std::strncmp(argv[i], "--backend=", 10) == 0) {
+            inference_backend = argv[i] + 10;
+        } else if (std::strcmp(argv[i], "--roi") == 0) {
+            use_roi = true;
+        } else if (std::strcmp(argv[i], "--no-roi") == 0) {
+            use_roi = false;
+        } else if (std::strncmp(argv[i], "--skip=", 7) == 0) {
+            skip_stride = std::max(1, std::atoi(argv[i] + 7));
+        } else if (std::strncmp(argv[i], "--metrics=", 10) == 0) {
+            metrics_path = argv[i] + 10;
+            metrics_enabled = true;
+        } else if (std::strncmp(argv[i], "--metrics-interval=", 19) == 0) {
+            metrics_interval = std::atof(argv[i] + 19);
+        } else if (std::strcmp(argv[i], "--no-metrics") == 0) {
+            metrics_enabled = false;
+        } else if (std::strncmp(argv[i], "--codec=", 8) == 0) {
+            writer_options.codec = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--preset=", 9) == 0) {
+            writer_options.preset = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--quality=", 10) == 0) {
+            writer_options.quality = std::atoi(argv[i] + 10);
+        } else if (std::strncmp(argv[i], "--drop=", 7) == 0) {
+            source_options.drop_policy = argv[i] + 7;
+        } else if (std::strcmp(argv[i], "--no-output") == 0) {
+            write_output = false;
+        } else if (std::strcmp(argv[i], "--output") == 0) {
+            write_output = true;
+        } else if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            source_backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            source_input = argv[i] + 8;
+        }
+    }
+    if (source_input.empty()) {
+        source_input = (source_backend == "synthetic") ? "default" : Config::SOURCE_VIDEO_PATH;
+    }
+    // Stream live không thể decode nhanh hơn thời gian thực -> mặc định paced
+    if (!decode_mode_set && source_input.find("://") != std::string::npos) {
+        source_options.offline_decode = false;
+    }
+    
+    // Metrics ghi định kỳ trên thread riêng; destructor ghi snapshot cuối (kể cả khi return sớm)
+    Metrics::setEnabled(metrics_enabled);
+    Metrics::Exporter metrics_exporter;
+    if (metrics_enabled && !metrics_path.empty()) {
+        metrics_exporter.start(metrics_path, metrics_interval);
+    }
+
+    // Không ghi video -> không cần full-res: nguồn thu nhỏ khi decode cho cạnh dài = input của model
+    // (giữ tỉ lệ, letterbox trong detector chỉ còn đệm). Không vẽ / encode -> không cần BGR:
+    // VLC giao thẳng RGB của model, bỏ đảo kênh mỗi frame
+    if (!write_output) {
+        source_options.output_size = cv::Size(Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE);
+        source_options.rgb_frames = true;
+    }
 
-int main() {
     // ====================================================
     // 1. KHỞI TẠO HỆ THỐNG
     // ====================================================
     std::cout << "[INFO] Đang khởi tạo Pickleball Detector (New Update)..." << std::endl;
     
-    // Hàm này sẽ load model từ Config::MODEL_PATH (model_ver2.onnx)
-    initialize_detector();
+    // Load model (mặc định Config::MODEL_PATH, ghi đè bằng --model=) 1 lần, session giữ state của video này
+    auto load_start = std::chrono::steady_clock::now();
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load(model_path, inference_backend);
+    if (!model) {
+        return -1;
+    }
+    DetectorSession session(model);
+    double model_load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - load_start).count();
 
     // ====================================================
-    // 2. MỞ VIDEO NGUỒN (SỬ DỤNG VLC)
+    // 2. MỞ VIDEO NGUỒN
     // ====================================================
-    std::cout << "[INFO] Đang mở video bằng VLC: " << Config::SOURCE_VIDEO_PATH << std::endl;
-    
-    // Sử dụng VLC để đọc video
-    VLCVideoReader cap;
-    if (!cap.open(Config::SOURCE_VIDEO_PATH)) {
-        std::cerr << "[ERROR] Không thể mở video nguồn bằng VLC! " << std::endl;
-        std::cerr << " -> Hãy kiểm tra lại đường dẫn trong config.hpp" << std::endl;
-        std::cerr << " -> Đường dẫn hiện tại: " << Config::SOURCE_VIDEO_PATH << std::endl;
-        std::cerr << " -> Kiểm tra xem VLC đã được cài đặt chưa (libvlc-dev trên Linux, vlc trên Windows)" << std::endl;
+    std::cout << "[INFO] Đang mở nguồn [" << source_backend << "]: " << source_input;
+    if (!source_options.output_size.empty()) {
+        std::cout << " (decode trong khung " << source_options.output_size.width << "x" << source_options.output_size.height << ", giữ tỉ lệ)";
+    }
+    std::cout << std::endl;
+    
+    std::unique_ptr<FrameSource> source = createFrameSource(source_backend, source_options);
+    if (!source) {
+        return -1;
+    }
+    FrameSource& cap = *source;
+    auto open_start = std::chrono::steady_clock::now();
+    if (!cap.open(source_input)) {
+        std::cerr << "[ERROR] Không thể mở video nguồn bằng backend " << source_backend << "!" << std::endl;
+        std::cerr << " -> Hãy kiểm tra lại đường dẫn trong config.hpp hoặc tham số --input=" << std::endl;
+        std::cerr << " -> Đường dẫn hiện tại: " << source_input << std::endl;
+        if (source_backend == "vlc") {
+            std::cerr << " -> Kiểm tra xem VLC đã được cài đặt chưa (libvlc-dev trên Linux, vlc trên Windows)" << std::endl;
+        }
         return -1;
     }
     
-    std::cout << "[INFO] Video đã mở thành công với VLC" << std::endl;
+    // Line sân đọc frame tham chiếu từ cùng nguồn (nguồn riêng, luôn BGR)
+    session.configure_court(source_backend, source_input);
+    session.set_input_order(cap.channelOrder());
+    session.set_native_size(cap.nativeFrameSize());
+    
+    double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count();
+    std::cout << "[INFO] Nguồn video đã mở thành công (open: " << cv::format("%.1f", open_ms) << "ms)" << std::endl;
 
     // Lấy FPS và tổng số frame từ properties
     double fps = cap.get(cv::CAP_PROP_FPS);
@@ -60,6 +218,16 @@ int main() {
         return -1;
     }
     
+    // Startup metric: thời gian từ lúc mở nguồn tới khi có frame đầu tiên
+    double first_frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count();
+    std::cout << "[INFO] Startup - time-to-first-frame: " << cv::format("%.1f", first_frame_ms) << "ms";
+#ifdef HAVE_LIBVLC
+    if (auto* vlc_source = dynamic_cast<VLCVideoReader*>(source.get())) {
+        std::cout << " (VLC giao frame đầu tiên sau " << cv::format("%.1f", vlc_source->getTimeToFirstFrameMs()) << "ms)";
+    }
+#endif
+    std::cout << std::endl;
+    
     // Lấy kích thước thực tế từ frame (chính xác hơn properties)
     int frame_width = first_frame.cols;
     int frame_height = first_frame.rows;
@@ -76,13 +244,15 @@ int main() {
     }
 
     // ====================================================
-    // 4. TẠO VIDEO ĐÍCH
+    // 4. TẠO VIDEO ĐÍCH (chỉ khi bật ghi video annotation)
     // ====================================================
-    int fourcc = cv::VideoWriter::fourcc('m', 'p', '4', 'v');
-    cv::VideoWriter writer(Config::TARGET_VIDEO_PATH, fourcc, fps, 
-                           cv::Size(frame_width, frame_height));
+    // Encode chạy trên thread riêng của AsyncVideoWriter
+    AsyncVideoWriter writer;
+    if (write_output) {
+        writer.open(Config::TARGET_VIDEO_PATH, fps, cv::Size(frame_width, frame_height), writer_options);
+    }
 
-    if (!writer.isOpened()) {
+    if (write_output && !writer.isOpened()) {
         std::cerr << "[ERROR] Không thể tạo file video đích: " 
                   << Config::TARGET_VIDEO_PATH << std::endl;
         std::cerr << "[ERROR] Kích thước: " << frame_width << "x" << frame_height 
@@ -91,67 +261,284 @@ int main() {
         return -1;
     }
     
-    std::cout << "[INFO] VideoWriter đã được tạo thành công" << std::endl;
+    if (write_output) {
+        std::cout << "[INFO] VideoWriter đã được tạo thành công" << std::endl;
+    } else {
+        std::cout << "[INFO] Không ghi video đầu ra (chỉ detect)" << std::endl;
+    }
 
     // ====================================================
-    // 5. VÒNG LẶP XỬ LÝ - GHI TRỰC TIẾP FRAME ĐỌC ĐƯỢC (DEBUG MODE)
+    // 5. VÒNG LẶP XỬ LÝ
     // ====================================================
-    std::cout << "[INFO] Bắt đầu ghi video (ghi trực tiếp frame đọc được, không qua xử lý)..." << std::endl;
+    // Chia đoạn cần seek tới giữa video -> chỉ với file đã biết tổng số frame
+    bool use_segments = segments > 1;
+    if (use_segments && (total_frames <= 0 || source_input.find("://") != std::string::npos)) {
+        std::cerr << "[WARNING] Không chia đoạn được (stream hoặc không biết tổng số frame), chạy 1 luồng" << std::endl;
+        use_segments = false;
+    }
+    // Bỏ bớt frame inference / ROI quyết định theo kết quả tracking của chính frame trước đó và
+    // chạy YOLO lại ngay trên frame đang xử lý -> chỉ làm được trong vòng lặp tuần tự
+    if (skip_stride > 1 || use_roi) {
+        if (use_segments) {
+            std::cerr << "[WARNING] --skip / --roi không áp dụng khi chia đoạn (mọi frame chạy YOLO cả frame)" << std::endl;
+            skip_stride = 1;
+            use_roi = false;
+        } else {
+            session.set_inference_stride(skip_stride);
+            use_roi = session.set_roi_inference(use_roi);
+            if (use_pipeline && (skip_stride > 1 || use_roi)) {
+                std::cout << "[INFO] --skip / --roi: chuyển sang vòng lặp tuần tự" << std::endl;
+                use_pipeline = false;
+            }
+        }
+    }
+
+    // Chia đoạn là xử lý offline (không có nhịp thời gian thực) -> không điều chỉnh chất lượng
+    QualityController quality(use_segments ? 0.0 : target_fps, Config::QUALITY_WINDOW_FRAMES);
+    if (quality.enabled()) {
+        std::cout << "[INFO] Điều chỉnh chất lượng theo tải: target " << target_fps << " fps" << std::endl;
+        quality.probeInputSizes(session);
+    }
+
+    // Warm-up sau các lần forward thử ở trên -> engine dừng ở shape của frame thật
+    WarmupStats warmup = session.warm_up(warmup_runs, (use_segments || use_pipeline) ? batch_size : 1);
+    if (warmup.runs > 0) {
+        std::cout << "[INFO] Warm-up: " << warmup.runs << " lần forward giả, " << cv::format("%.1f", warmup.total_ms)
+                  << "ms (lần đầu " << cv::format("%.1f", warmup.first_ms) << "ms, lần cuối "
+                  << cv::format("%.1f", warmup.last_ms) << "ms)" << std::endl;
+    }
+    double startup_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - program_start).count();
+    std::cout << "[INFO] Startup - sẵn sàng xử lý sau " << cv::format("%.1f", startup_ms) << "ms (load model + engine: "
+              << cv::format("%.1f", model_load_ms) << "ms, warm-up: " << cv::format("%.1f", warmup.total_ms) << "ms)" << std::endl;
+    const char* mode_name = use_segments ? "chia đoạn" : (use_pipeline ? "pipeline" : "tuần tự");
+    std::cout << "[INFO] Bắt đầu xử lý video (" << mode_name << ")..." << std::endl;
 
-    // Ghi frame đầu tiên đã đọc trực tiếp
     std::cout << "[DEBUG] Frame đầu tiên - kích thước: " << first_frame.cols << "x" << first_frame.rows 
               << ", channels: " << first_frame.channels() << std::endl;
-    writer.write(first_frame);
-    
-    // In tiến độ cho frame đầu tiên
-    if (total_frames > 0) {
-        float progress = (float)1 / total_frames * 100.0f;
-        std::cout << "Processing: 1/" << total_frames 
-                  << " (" << (int)progress << "%)" << "\r" << std::flush;
-    }
 
-    cv::Mat frame;
-    int frame_idx = 1;  // Bắt đầu từ 1 vì đã ghi frame 0
+    // In tiến độ (frame_idx tính từ 0)
+    auto print_progress = [total_frames](int frame_idx) {
+        int done = frame_idx + 1;
+        if (frame_idx != 0 && done % 50 != 0) {
+            return;
+        }
+        if (total_frames > 0) {
+            float progress = (float)done / total_frames * 100.0f;
+            std::cout << "Processing: " << done << "/" << total_frames 
+                      << " (" << (int)progress << "%)" << "\r" << std::flush;
+        } else {
+            std::cout << "Processing: " << done << " frames" << "\r" << std::flush;
+        }
+    };
+
+    int frame_idx = 0;
 
-    while (true) {
-        cap >> frame;
+    // Độ trễ xử lý frame đầu tiên (tách khỏi startup): tuần tự = update() của frame 0,
+    // pipeline = từ lúc chạy tới khi frame 0 ra khỏi stage cuối. Chia đoạn: không đo (< 0)
+    double first_frame_latency_ms = -1.0;
+    
+    // Thời gian chờ nguồn frame -> so sánh tốc độ ingest giữa các backend
+    double read_seconds = 0.0;
+
+    if (use_segments) {
+        // Nguồn chính chỉ dùng để lấy frame đầu tiên: dừng luôn, nếu không VLC (paced) vẫn phát và bỏ frame nền
+        cap.release();
 
-        if (frame.empty()) {
-            std::cout << std::endl << "[INFO] Đã đọc hết video (frame rỗng tại frame " << frame_idx << ")" << std::endl;
-            break;
+        // Mỗi đoạn mở nguồn riêng cùng kích thước frame / thứ tự kênh, nhưng luôn decode offline và
+        // chặn khi đầy (kể cả --paced): chia đoạn cần đủ mọi frame theo đúng thứ tự
+        FrameSourceOptions segment_options = source_options;
+        segment_options.offline_decode = true;
+        segment_options.drop_policy = "block";
+        if (!source_options.offline_decode || source_options.drop_policy != "auto") {
+            std::cout << "[INFO] Chia đoạn: nguồn của các đoạn luôn decode offline, không bỏ frame (bỏ qua --paced / --drop=)" << std::endl;
         }
+        auto open_segment_source = [&]() -> std::unique_ptr<FrameSource> {
+            std::unique_ptr<FrameSource> segment_source = createFrameSource(source_backend, segment_options);
+            if (segment_source && !segment_source->open(source_input)) {
+                segment_source.reset();
+            }
+            return segment_source;
+        };
+        SegmentRunner runner(segments, Config::SEGMENT_OVERLAP_FRAMES, batch_size);
+        std::vector<FrameResult> results;
+        if (!runner.run(model, session, open_segment_source, total_frames, first_frame.size(), results)) {
+            writer.release();
+            return -1;
+        }
+        runner.printReport();
+        frame_idx = static_cast<int>(results.size());
 
-        // Kiểm tra kích thước frame có khớp với VideoWriter không
-        if (frame.cols != frame_width || frame.rows != frame_height) {
-            std::cerr << std::endl << "[WARNING] Frame " << frame_idx 
-                      << " có kích thước " << frame.cols << "x" << frame.rows
-                      << " không khớp với VideoWriter " << frame_width << "x" << frame_height << std::endl;
-            std::cerr << "[INFO] Vẫn thử ghi frame này..." << std::endl;
+        // Vẽ kết quả đã nối lên video: decode lại từ frame 0 bằng nguồn mới (offline, không bỏ frame)
+        if (write_output && !results.empty()) {
+            std::unique_ptr<FrameSource> render_source = open_segment_source();
+            if (!render_source) {
+                std::cerr << "[ERROR] Không mở lại được nguồn để ghi video" << std::endl;
+                writer.release();
+                return -1;
+            }
+            std::chrono::steady_clock::duration read_time{};
+            FrameLease lease;
+            for (int idx = 0; idx < frame_idx; idx++) {
+                auto read_start = std::chrono::steady_clock::now();
+                if (!render_source->readLease(lease)) {
+                    std::cerr << std::endl << "[WARNING] Nguồn hết frame khi ghi video tại frame " << idx << std::endl;
+                    break;
+                }
+                read_time += std::chrono::steady_clock::now() - read_start;
+                Metrics::record(Metrics::DECODE, std::chrono::steady_clock::now() - read_start);
+                // Kết quả đoạn gắn theo vị trí frame -> frame lệch thì annotation vẽ sai chỗ, dừng hẳn
+                if (lease.frameNumber() >= 0 && lease.frameNumber() != idx) {
+                    std::cerr << std::endl << "[ERROR] Nguồn giao frame " << lease.frameNumber() << " khi ghi frame " << idx
+                              << " (decode lại bị lệch), dừng ghi video" << std::endl;
+                    render_source->release();
+                    writer.release();
+                    return -1;
+                }
+                cv::Mat annotated = lease.mat().clone();
+                annotate_frame(annotated, results[idx]);
+                writer.write(annotated);
+                print_progress(idx);
+            }
+            std::cout << std::endl;
+            read_seconds = std::chrono::duration<double>(read_time).count();
+            render_source->release();
         }
+    } else if (use_pipeline) {
+        // Mỗi stage 1 thread; encode (ghi video) chạy trên thread này, frame tới đúng thứ tự
+        FramePipeline pipeline(Config::PIPELINE_QUEUE_CAPACITY, batch_size);
+        pipeline.setQualityController(quality.enabled() ? &quality : nullptr);
+        pipeline.setAnnotate(write_output);
+        auto pipeline_start = std::chrono::steady_clock::now();
+        frame_idx = pipeline.run(session, cap, first_frame, [&](const cv::Mat& annotated, int idx) {
+            if (idx == 0) {
+                first_frame_latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipeline_start).count();
+            }
+            if (write_output) {
+                writer.write(annotated);
+            }
+            print_progress(idx);
+        });
+        std::cout << std::endl;
+        if (frame_idx < 0) {
+            cap.release();
+            writer.release();
+            return -1;
+        }
+        read_seconds = pipeline.decodeSeconds();
+        pipeline.printReport();
+    } else {
+        // Xử lý frame đầu tiên đã đọc. Không ghi video -> process() (không clone, không vẽ annotation)
+        auto process_start = std::chrono::steady_clock::now();
+        cv::Mat annotated;
+        if (write_output) {
+            annotated = session.update(first_frame, 0, quality.qualityFor(0));
+        } else {
+            session.process(first_frame, 0, quality.qualityFor(0));
+        }
+        first_frame_latency_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - process_start).count();
+        if (write_output) {
+            writer.write(annotated);
+        }
+        quality.record(0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - process_start).count());
+        print_progress(0);
+
+        // Mượn frame từ nguồn (VLC ring: zero-copy), trả lại sau mỗi vòng lặp
+        FrameLease lease;
+        cv::Mat frame;
+        frame_idx = 1;  // Bắt đầu từ 1 vì đã xử lý frame 0
+        std::chrono::steady_clock::duration read_time{};
 
-        // Ghi trực tiếp frame đọc được vào video (KHÔNG qua xử lý)
-        writer.write(frame);
+        while (true) {
+            auto read_start = std::chrono::steady_clock::now();
+            frame = cap.readLease(lease) ? lease.mat() : cv::Mat();
+            read_time += std::chrono::steady_clock::now() - read_start;
+            if (!frame.empty()) {
+                Metrics::record(Metrics::DECODE, std::chrono::steady_clock::now() - read_start);
+            }
 
-        // In tiến độ
-        if (frame_idx % 50 == 0) {
-            if (total_frames > 0) {
-                float progress = (float)frame_idx / total_frames * 100.0f;
-                std::cout << "Processing: " << frame_idx << "/" << total_frames 
-                          << " (" << (int)progress << "%)" << "\r" << std::flush;
+            if (frame.empty()) {
+                std::cout << std::endl << "[INFO] Đã đọc hết video (frame rỗng tại frame " << frame_idx << ")" << std::endl;
+                break;
+            }
+
+            // Kiểm tra kích thước frame có khớp với VideoWriter không
+            if (frame.cols != frame_width || frame.rows != frame_height) {
+                std::cerr << std::endl << "[WARNING] Frame " << frame_idx 
+                          << " có kích thước " << frame.cols << "x" << frame.rows
+                          << " không khớp với VideoWriter " << frame_width << "x" << frame_height << std::endl;
+                std::cerr << "[INFO] Vẫn thử ghi frame này..." << std::endl;
+            }
+
+            // Thời gian xử lý tính từ sau khi có frame -> controller không phạt lúc chờ nguồn live
+            process_start = std::chrono::steady_clock::now();
+            if (write_output) {
+                writer.write(session.update(frame, frame_idx, quality.qualityFor(frame_idx)));
             } else {
-                std::cout << "Processing: " << frame_idx << " frames" << "\r" << std::flush;
+                session.process(frame, frame_idx, quality.qualityFor(frame_idx));
             }
+            quality.record(frame_idx, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - process_start).count());
+            print_progress(frame_idx);
+
+            frame_idx++;
         }
+        read_seconds = std::chrono::duration<double>(read_time).count();
+    }
+
+    if (write_output) {
+        std::cout << std::endl << "[INFO] Hoàn tất! Video đã lưu tại: " 
+                  << Config::TARGET_VIDEO_PATH << std::endl;
+    } else {
+        std::cout << std::endl << "[INFO] Hoàn tất! (không ghi video đầu ra)" << std::endl;
+    }
+    
+    std::cout << "[INFO] Nguồn [" << cap.name() << "] - " << frame_idx << " frame, thời gian đọc: "
+              << cv::format("%.2f", read_seconds) << "s";
+    if (read_seconds > 0.0) {
+        std::cout << " (" << cv::format("%.1f", frame_idx / read_seconds) << " fps ingest)";
+    }
+    std::cout << std::endl;
 
-        frame_idx++;
+    std::cout << "[INFO] Startup " << cv::format("%.1f", startup_ms) << "ms (load model + engine "
+              << cv::format("%.1f", model_load_ms) << "ms, warm-up " << cv::format("%.1f", warmup.total_ms) << "ms)";
+    if (first_frame_latency_ms >= 0.0) {
+        std::cout << ", frame đầu tiên xử lý trong " << cv::format("%.1f", first_frame_latency_ms) << "ms";
+    }
+    std::cout << std::endl;
+    
+#ifdef HAVE_LIBVLC
+    VLCVideoReader* vlc = dynamic_cast<VLCVideoReader*>(source.get());
+    if (vlc && Config::VLC_RING_MODE) {
+        std::cout << "[INFO] VLC ring (" << (source_options.offline_decode ? "offline" : "paced") << ")"
+                  << " - Frame đã decode: " << vlc->getDecodedFrames()
+                  << ", frame bị bỏ: " << vlc->getDroppedFrames()
+                  << ", frame trễ: " << vlc->getLateFrames()
+                  << ", tốc độ decode: " << cv::format("%.1f", vlc->getDecodeFps()) << " fps" << std::endl;
     }
+#endif
 
-    std::cout << std::endl << "[INFO] Hoàn tất! Video đã lưu tại: " 
-              << Config::TARGET_VIDEO_PATH << std::endl;
+    quality.printReport();
+    const SkipStats& skip = session.skip_stats();
+    if (skip_stride > 1) {
+        std::cout << "[INFO] Bỏ frame inference (1/" << skip_stride << "): YOLO " << skip.inferences << "/" << skip.frames
+                  << " frame (tiết kiệm " << cv::format("%.1f", skip.frames > 0 ? 100.0 * (skip.frames - skip.inferences) / skip.frames : 0.0)
+                  << "%), tìm cục bộ " << skip.local_frames << " frame, quay lại YOLO vì match kém " << skip.fallbacks << " lần" << std::endl;
+    }
+    if (use_roi) {
+        std::cout << "[INFO] ROI " << Config::ROI_CROP_SIZE << "px -> " << Config::ROI_INPUT_SIZE << ": " << skip.roi_frames
+                  << "/" << skip.inferences << " lần YOLO chỉ chạy trên ROI, chạy lại cả frame vì ROI trượt "
+                  << skip.roi_fallbacks << " lần" << std::endl;
+    }
 
-    // Dọn dẹp
+    // Dọn dẹp (release() của writer chờ encode hết hàng đợi)
     cap.release();
-    writer.release();
+    if (write_output) {
+        writer.release();
+        writer.printReport();
+    }
+    
+    // Sau khi writer xong để histogram encode đủ mọi frame
+    Metrics::printReport();
+    metrics_exporter.stop();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+// Tạo bộ ảnh calibration cho model INT8 từ video trận đấu
+//
+// Đọc video qua FrameSource (như run_app), lấy --frames=N frame trải đều cả video, letterbox về
+// MODEL_INPUT_SIZE rồi ghi calib_XXXX.png vào Config::INT8_CALIBRATION_DIR (xóa ảnh cũ).
+// Backend "opencv-int8" dùng các ảnh này để lượng tử hóa model (1 lần mỗi process). Cùng bộ ảnh cũng
+// dùng được làm dữ liệu calibration cho onnxruntime.quantization.quantize_static (Python) để xuất
+// model INT8 QDQ, chạy bằng run_app --model=<file.onnx>.
+//
+// Sau khi ghi: lượng tử hóa thử, in thời gian forward FP32 vs INT8 trên chính các ảnh calibration.
+// Độ chính xác trên cả clip (bóng, bounce) kiểm tra bằng check_accuracy.
+//
+// Tham số: --frames=N (mặc định INT8_CALIBRATION_FRAMES), --source=, --input= (mặc định video
+// SOURCE_VIDEO_PATH qua nguồn opencv)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/utils/filesystem.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "detectors/inference_backend.hpp"
+#include "utils/frame_source.hpp"
+#include "utils/letterbox.hpp"
+
+namespace {
+    double mean_forward_ms(InferenceBackend& engine, const std::vector<cv::Mat>& blobs) {
+        engine.forward(blobs[0]);  // Lần đầu cấp phát / khởi tạo layer, không tính
+        auto start = std::chrono::steady_clock::now();
+        for (const cv::Mat& blob : blobs) {
+            engine.forward(blob);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / blobs.size();
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string backend = "opencv";
+    std::string input = Config::SOURCE_VIDEO_PATH;
+    int count = Config::INT8_CALIBRATION_FRAMES;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            count = std::max(1, std::atoi(argv[i] + 9));
+        }
+    }
+
+    std::unique_ptr<FrameSource> source = createFrameSource(backend);
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn [" << backend << "]: " << input << std::endl;
+        return -1;
+    }
+
+    // Trải đều cả video (rally, nghỉ, góc sáng khác nhau) bằng cách đọc tuần tự và lấy 1 trên `step`
+    // frame -> không cần nguồn seek được
+    int total_frames = static_cast<int>(source->get(cv::CAP_PROP_FRAME_COUNT));
+    int step = total_frames > count ? total_frames / count : 1;
+
+    const std::string& dir = Config::INT8_CALIBRATION_DIR;
+    if (!cv::utils::fs::createDirectories(dir)) {
+        std::cerr << "[ERROR] Không tạo được thư mục " << dir << std::endl;
+        return -1;
+    }
+    std::vector<cv::String> old_files;
+    cv::glob(dir + "/calib_*.png", old_files, false);
+    for (const cv::String& file : old_files) {
+        std::remove(file.c_str());
+    }
+
+    int saved = 0;
+    cv::Mat frame;
+    for (int idx = 0; saved < count && source->read(frame); idx++) {
+        if (idx % step != 0) {
+            continue;
+        }
+        std::string path = dir + cv::format("/calib_%04d.png", saved);
+        if (!cv::imwrite(path, Letterbox::image(frame, Config::MODEL_INPUT_SIZE))) {
+            std::cerr << "[ERROR] Không ghi được " << path << std::endl;
+            return -1;
+        }
+        saved++;
+    }
+    source->release();
+    if (saved == 0) {
+        std::cerr << "[ERROR] Nguồn không có frame nào" << std::endl;
+        return -1;
+    }
+    std::cout << "[INFO] Đã ghi " << saved << " ảnh calibration (1 trên " << step << " frame) vào " << dir << std::endl;
+
+    // --- Lượng tử hóa thử và so thời gian forward ---
+    std::shared_ptr<const DetectorModel> model = DetectorModel::load(Config::MODEL_PATH, "opencv");
+    if (!model) {
+        return -1;
+    }
+    std::vector<cv::Mat> blobs = loadCalibrationBlobs(dir);
+    try {
+        std::unique_ptr<InferenceBackend> fp32 = createInferenceBackend("opencv", model->onnxBytes());
+        std::unique_ptr<InferenceBackend> int8 = createInferenceBackend("opencv-int8", model->onnxBytes());
+        if (!fp32 || !int8) {
+            return -1;
+        }
+        double fp32_ms = mean_forward_ms(*fp32, blobs);
+        double int8_ms = mean_forward_ms(*int8, blobs);
+        std::cout << "[INFO] Forward: " << fp32->name() << " " << cv::format("%.2f", fp32_ms) << "ms, "
+                  << int8->name() << " " << cv::format("%.2f", int8_ms) << "ms (x"
+                  << cv::format("%.2f", int8_ms > 0.0 ? fp32_ms / int8_ms : 0.0) << ")" << std::endl;
+    } catch (const cv::Exception& e) {
+        std::cerr << "[ERROR] Lượng tử hóa thất bại: " << e.what() << std::endl;
+        return -1;
+    }
+    std::cout << "[INFO] Kiểm tra độ chính xác trên cả clip: check_accuracy --backend=opencv-int8" << std::endl;
+    return 0;
+}
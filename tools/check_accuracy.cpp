@@ -0,0 +1,181 @@
+// Kiểm tra độ chính xác model / backend thử (INT8, FP16, ...) so với model FP32 gốc
+//
+// 2 session xử lý cùng từng frame (đọc 1 lần, chạy lần lượt nên không cần giữ cả video trong RAM):
+// session gốc (Config::MODEL_PATH, backend opencv) và session thử (--model=, --backend=). So:
+//   vị trí bóng FrameResult::ball: lệch (px) mean / p95 / max, số frame mất bóng / thừa bóng
+//   sự kiện nảy (bounce hoặc bounce_point): ghép với sự kiện gốc trong ±BOUNCE_FRAME_TOLERANCE frame,
+//   precision / recall, lệch vị trí điểm nảy, số lần kết luận IN / OUT khác gốc
+//   thời gian xử lý mỗi bên
+//
+// --scaled: session thử nhận frame thu nhỏ vào khung MODEL_INPUT_SIZE (như nguồn decode khi chạy --no-output)
+// và đưa kết quả về tọa độ gốc -> kiểm tra chạy không ghi video cho cùng vị trí bóng / nảy với chạy
+// full-res, ví dụ: check_accuracy --backend=opencv --scaled
+//
+// Tham số: --model=<file.onnx> (mặc định MODEL_PATH), --backend= (mặc định opencv-int8), --scaled,
+// --frames=N (mặc định 0 = cả video), --source=, --input= (mặc định video SOURCE_VIDEO_PATH qua nguồn opencv)
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "config.hpp"
+#include "detectors/ball_detector.hpp"
+#include "utils/frame_source.hpp"
+#include "utils/ball_comparison.hpp"
+
+namespace {
+    constexpr int BOUNCE_FRAME_TOLERANCE = 2;
+
+    struct BounceEvent {
+        int frame_idx;
+        cv::Point point;
+        std::optional<bool> in;
+    };
+
+    std::optional<BounceEvent> bounce_event(const FrameResult& result) {
+        if (result.bounce_point) {
+            std::optional<bool> in;
+            if (result.bounce_point_check) {
+                in = result.bounce_point_check->in;
+            }
+            return BounceEvent{ result.frame_idx, *result.bounce_point, in };
+        }
+        if (result.bounce) {
+            std::optional<bool> in;
+            if (result.bounce_check) {
+                in = result.bounce_check->in;
+            }
+            return BounceEvent{ result.frame_idx, result.angle_points[1], in };
+        }
+        return std::nullopt;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string source_backend = "opencv";
+    std::string input = Config::SOURCE_VIDEO_PATH;
+    std::string model_path = Config::MODEL_PATH;
+    std::string inference_backend = "opencv-int8";
+    int max_frames = 0;
+    bool scaled = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--source=", 9) == 0) {
+            source_backend = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--input=", 8) == 0) {
+            input = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--model=", 8) == 0) {
+            model_path = argv[i] + 8;
+        } else if (std::strncmp(argv[i], "--backend=", 10) == 0) {
+            inference_backend = argv[i] + 10;
+        } else if (std::strncmp(argv[i], "--frames=", 9) == 0) {
+            max_frames = std::max(0, std::atoi(argv[i] + 9));
+        } else if (std::strcmp(argv[i], "--scaled") == 0) {
+            scaled = true;
+        }
+    }
+
+    std::shared_ptr<const DetectorModel> reference_model = DetectorModel::load(Config::MODEL_PATH, "opencv");
+    std::shared_ptr<const DetectorModel> candidate_model = DetectorModel::load(model_path, inference_backend);
+    if (!reference_model || !candidate_model) {
+        return -1;
+    }
+
+    std::unique_ptr<FrameSource> source = createFrameSource(source_backend);
+    if (!source || !source->open(input)) {
+        std::cerr << "[ERROR] Không mở được nguồn [" << source_backend << "]: " << input << std::endl;
+        return -1;
+    }
+    DetectorSession reference(reference_model);
+    DetectorSession candidate(candidate_model);
+    reference.configure_court(source_backend, input);
+    candidate.configure_court(source_backend, input);
+
+    BallComparison ball_comparison;
+    std::vector<BounceEvent> expected_bounces;
+    std::vector<BounceEvent> actual_bounces;
+    double reference_seconds = 0.0;
+    double candidate_seconds = 0.0;
+    int count = 0;
+    const cv::Size box(Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE);
+    cv::Mat frame;
+    cv::Mat small;
+    while ((max_frames == 0 || count < max_frames) && source->read(frame)) {
+        if (scaled) {
+            // Cùng phép thu nhỏ với FrameSource::setOutputSize (INTER_LINEAR, giữ tỉ lệ)
+            cv::resize(frame, small, FrameSource::fitInto(frame.size(), box), 0, 0, cv::INTER_LINEAR);
+            candidate.set_native_size(frame.size());
+        }
+        auto start = std::chrono::steady_clock::now();
+        FrameResult expected = reference.process(frame, count);
+        auto middle = std::chrono::steady_clock::now();
+        FrameResult actual = candidate.process(scaled ? small : frame, count);
+        auto end = std::chrono::steady_clock::now();
+        reference_seconds += std::chrono::duration<double>(middle - start).count();
+        candidate_seconds += std::chrono::duration<double>(end - middle).count();
+        count++;
+
+        ball_comparison.add(expected.ball, actual.ball);
+        if (auto event = bounce_event(expected)) {
+            expected_bounces.push_back(*event);
+        }
+        if (auto event = bounce_event(actual)) {
+            actual_bounces.push_back(*event);
+        }
+    }
+    source->release();
+    if (count == 0) {
+        std::cerr << "[ERROR] Nguồn không có frame nào" << std::endl;
+        return -1;
+    }
+
+    // Ghép mỗi sự kiện gốc với sự kiện thử gần nhất (theo frame) chưa được ghép, trong ±tolerance
+    std::vector<bool> used(actual_bounces.size(), false);
+    std::vector<double> bounce_errors;
+    int in_out_mismatches = 0;
+    for (const BounceEvent& e : expected_bounces) {
+        int best = -1;
+        for (size_t j = 0; j < actual_bounces.size(); j++) {
+            int distance = std::abs(actual_bounces[j].frame_idx - e.frame_idx);
+            if (used[j] || distance > BOUNCE_FRAME_TOLERANCE) {
+                continue;
+            }
+            if (best < 0 || distance < std::abs(actual_bounces[best].frame_idx - e.frame_idx)) {
+                best = static_cast<int>(j);
+            }
+        }
+        if (best < 0) {
+            continue;
+        }
+        used[best] = true;
+        const BounceEvent& a = actual_bounces[best];
+        bounce_errors.push_back(std::hypot(e.point.x - a.point.x, e.point.y - a.point.y));
+        if (e.in && a.in && *e.in != *a.in) {
+            in_out_mismatches++;
+        }
+    }
+    const size_t matched = bounce_errors.size();
+
+    std::cout << "[INFO] " << count << " frame, gốc: " << Config::MODEL_PATH << " [opencv], thử: "
+              << model_path << " [" << inference_backend << "]"
+              << (scaled ? cv::format(", frame thu nhỏ vào %dx%d", box.width, box.height) : std::string()) << std::endl;
+    std::cout << "  Thời gian: gốc " << cv::format("%.2f", reference_seconds) << "s ("
+              << cv::format("%.1f", count / reference_seconds) << " fps), thử " << cv::format("%.2f", candidate_seconds)
+              << "s (" << cv::format("%.1f", count / candidate_seconds) << " fps, x"
+              << cv::format("%.2f", candidate_seconds > 0.0 ? reference_seconds / candidate_seconds : 0.0) << ")" << std::endl;
+    ball_comparison.print(std::cout);
+    std::cout << "  Nảy: gốc " << expected_bounces.size() << ", thử " << actual_bounces.size() << ", khớp " << matched
+              << " (±" << BOUNCE_FRAME_TOLERANCE << " frame), recall "
+              << cv::format("%.1f", expected_bounces.empty() ? 100.0 : 100.0 * matched / expected_bounces.size())
+              << "%, precision "
+              << cv::format("%.1f", actual_bounces.empty() ? 100.0 : 100.0 * matched / actual_bounces.size()) << "%" << std::endl;
+    std::cout << "  Lệch điểm nảy: " << BallComparison::format(BallComparison::summarize(bounce_errors))
+              << ", IN/OUT khác gốc: " << in_out_mismatches << "/" << matched << std::endl;
+    return 0;
+}
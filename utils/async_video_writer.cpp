@@ -0,0 +1,141 @@
+#include "async_video_writer.hpp"
+#include "metrics.hpp"
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <optional>
+
+namespace {
+    const char* const FFMPEG_WRITER_OPTIONS = "OPENCV_FFMPEG_WRITER_OPTIONS";
+
+    // value == nullptr: xóa biến
+    void set_env(const char* name, const char* value) {
+#ifdef _WIN32
+        _putenv_s(name, value ? value : "");
+#else
+        if (value) {
+            setenv(name, value, 1);
+        } else {
+            unsetenv(name);
+        }
+#endif
+    }
+}
+
+AsyncVideoWriter::~AsyncVideoWriter() {
+    release();
+}
+
+bool AsyncVideoWriter::openWriter(const std::string& path, const std::string& codec, double fps,
+                                  const cv::Size& frame_size, const Options& options) {
+    int fourcc;
+    std::vector<int> params;
+    bool override_env = false;
+    std::optional<std::string> saved_env;
+    if (codec == "h264") {
+        fourcc = cv::VideoWriter::fourcc('a', 'v', 'c', '1');
+        // Backend FFmpeg của OpenCV đọc option encoder từ biến môi trường ("key;value|key;value")
+        // lúc mở writer -> chỉ đặt quanh open(), trả lại giá trị cũ cho writer khác trong process
+        if (const char* previous = std::getenv(FFMPEG_WRITER_OPTIONS)) {
+            saved_env = previous;
+        }
+        set_env(FFMPEG_WRITER_OPTIONS, ("preset;" + options.preset).c_str());
+        override_env = true;
+    } else if (codec == "mjpg") {
+        fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+        params = { cv::VIDEOWRITER_PROP_QUALITY, options.quality };
+    } else {
+        if (codec != "mp4v") {
+            std::cerr << "[WARNING] Codec không hỗ trợ: " << codec << ", dùng mp4v" << std::endl;
+        }
+        fourcc = cv::VideoWriter::fourcc('m', 'p', '4', 'v');
+    }
+    
+    bool opened = writer_.open(path, cv::CAP_FFMPEG, fourcc, fps, frame_size, params) ||
+                  writer_.open(path, fourcc, fps, frame_size);
+    if (override_env) {
+        set_env(FFMPEG_WRITER_OPTIONS, saved_env ? saved_env->c_str() : nullptr);
+    }
+    if (!opened) {
+        return false;
+    }
+    codec_ = (codec == "h264" || codec == "mjpg") ? codec : "mp4v";
+    return true;
+}
+
+bool AsyncVideoWriter::open(const std::string& path, double fps, const cv::Size& frame_size, const Options& options) {
+    release();
+    
+    if (!openWriter(path, options.codec, fps, frame_size, options)) {
+        if (options.codec == "mp4v" || !openWriter(path, "mp4v", fps, frame_size, options)) {
+            return false;
+        }
+        std::cerr << "[WARNING] Không mở được encoder " << options.codec << ", chuyển sang mp4v" << std::endl;
+    }
+    
+    std::cout << "[INFO] VideoWriter: codec " << codec_;
+    if (codec_ == "h264") std::cout << " (preset " << options.preset << ")";
+    if (codec_ == "mjpg") std::cout << " (quality " << options.quality << ")";
+    std::cout << ", hàng đợi " << options.queue_capacity << " frame" << std::endl;
+    
+    frames_written_ = 0;
+    encode_ns_ = 0;
+    blocked_ = {};
+    frames_queued_ = 0;
+    queue_ = std::make_unique<BoundedQueue<cv::Mat>>(options.queue_capacity);
+    worker_ = std::thread(&AsyncVideoWriter::workerLoop, this);
+    return true;
+}
+
+void AsyncVideoWriter::workerLoop() {
+    cv::Mat frame;
+    while (queue_->pop(frame)) {
+        auto start = std::chrono::steady_clock::now();
+        writer_.write(frame);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        encode_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        Metrics::record(Metrics::ENCODE, elapsed);
+        frames_written_++;
+        frame.release();
+    }
+}
+
+void AsyncVideoWriter::write(const cv::Mat& frame) {
+    if (!queue_) {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    queue_->push(frame);
+    blocked_ += std::chrono::steady_clock::now() - start;
+    frames_queued_++;
+}
+
+void AsyncVideoWriter::release() {
+    if (queue_) {
+        queue_->close();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        max_depth_ = queue_->maxDepth();
+        average_depth_ = queue_->averageDepth();
+        queue_.reset();
+    }
+    writer_.release();
+}
+
+void AsyncVideoWriter::printReport() const {
+    uint64_t frames = frames_written_;
+    double encode_s = encode_ns_ / 1e9;
+    double blocked_ms = std::chrono::duration<double, std::milli>(blocked_).count();
+    
+    std::cout << "[INFO] Encoder [" << codec_ << "] - " << frames << " frame, encode: "
+              << cv::format("%.2f", encode_s) << "s";
+    if (encode_s > 0.0) {
+        std::cout << " (" << cv::format("%.1f", frames / encode_s) << " fps)";
+    }
+    std::cout << ", vòng lặp chính bị chặn: " << cv::format("%.0f", blocked_ms) << "ms";
+    if (frames_queued_ > 0) {
+        std::cout << " (" << cv::format("%.2f", blocked_ms / frames_queued_) << "ms/frame)";
+    }
+    std::cout << ", hàng đợi TB " << cv::format("%.1f", average_depth_) << " / max " << max_depth_ << std::endl;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "bounded_queue.hpp"
+
+/**
+ * @brief Ghi video trên thread riêng: write() chỉ đẩy frame vào hàng đợi có giới hạn,
+ * encode (cv::VideoWriter) chạy trên worker -> thời gian encode không cộng vào mỗi frame
+ * của vòng lặp chính, trừ khi encoder chậm hơn vòng lặp và hàng đợi đầy (backpressure).
+ */
+class AsyncVideoWriter {
+public:
+    /**
+     * @brief Tùy chọn encoder
+     * codec: "mp4v" (MPEG-4 Part 2, mặc định cũ), "h264" (avc1, nhỏ hơn nhiều, cần FFmpeg có
+     *        encoder H.264) hoặc "mjpg" (encode nhanh nhất, file lớn nhất)
+     * preset: preset của H.264 (ultrafast ... veryslow), đổi tốc độ encode lấy dung lượng file
+     * quality: 0-100, dùng cho MJPEG
+     */
+    struct Options {
+        std::string codec = "mp4v";
+        std::string preset = "veryfast";
+        int quality = 90;
+        size_t queue_capacity = 8;
+    };
+
+    AsyncVideoWriter() = default;
+    ~AsyncVideoWriter();
+    
+    AsyncVideoWriter(const AsyncVideoWriter&) = delete;
+    AsyncVideoWriter& operator=(const AsyncVideoWriter&) = delete;
+    
+    /**
+     * @brief Mở file đích và khởi động worker
+     * Codec không mở được (ví dụ thiếu encoder H.264) -> thử lại với mp4v
+     */
+    bool open(const std::string& path, double fps, const cv::Size& frame_size, const Options& options);
+    bool isOpened() const { return writer_.isOpened(); }
+    
+    /**
+     * @brief Đưa frame vào hàng đợi encode (chặn nếu hàng đợi đầy)
+     * Frame được giữ theo tham chiếu (không copy): caller không được sửa buffer sau khi write.
+     */
+    void write(const cv::Mat& frame);
+    
+    /**
+     * @brief Chờ encode hết frame còn trong hàng đợi rồi đóng file
+     */
+    void release();
+    
+    /**
+     * @brief Codec thực sự đang dùng (sau khi fallback)
+     */
+    const std::string& codec() const { return codec_; }
+    
+    /**
+     * @brief In thông lượng encoder và thời gian vòng lặp chính bị chặn bởi write()
+     */
+    void printReport() const;
+
+private:
+    bool openWriter(const std::string& path, const std::string& codec, double fps,
+                    const cv::Size& frame_size, const Options& options);
+    void workerLoop();
+    
+    cv::VideoWriter writer_;
+    std::string codec_;
+    std::unique_ptr<BoundedQueue<cv::Mat>> queue_;
+    std::thread worker_;
+    
+    std::atomic<uint64_t> frames_written_{0};
+    std::atomic<int64_t> encode_ns_{0};         // Thời gian worker encode
+    std::chrono::steady_clock::duration blocked_{};  // Thời gian write() chặn caller
+    uint64_t frames_queued_ = 0;
+    size_t max_depth_ = 0;
+    double average_depth_ = 0.0;
+};
@@ -0,0 +1,37 @@
+#include "ball_comparison.hpp"
+#include <algorithm>
+#include <cmath>
+
+BallComparison::ErrorStats BallComparison::summarize(std::vector<double> errors) {
+    ErrorStats stats;
+    if (errors.empty()) {
+        return stats;
+    }
+    std::sort(errors.begin(), errors.end());
+    for (double e : errors) {
+        stats.mean += e;
+    }
+    stats.mean /= errors.size();
+    stats.p95 = errors[std::min(errors.size() - 1, static_cast<size_t>(std::ceil(0.95 * errors.size())) - 1)];
+    stats.max = errors.back();
+    return stats;
+}
+
+std::string BallComparison::format(const ErrorStats& stats) {
+    return cv::format("mean %.2f px, p95 %.2f px, max %.2f px", stats.mean, stats.p95, stats.max);
+}
+
+void BallComparison::add(const std::optional<cv::Point>& expected, const std::optional<cv::Point>& actual) {
+    if (expected && actual) {
+        errors_.push_back(std::hypot(expected->x - actual->x, expected->y - actual->y));
+    } else if (expected) {
+        missed_++;
+    } else if (actual) {
+        extra_++;
+    }
+}
+
+void BallComparison::print(std::ostream& out) const {
+    out << "  Lệch vị trí bóng (" << errors_.size() << " frame cả 2 có bóng): " << format(summarize(errors_)) << std::endl;
+    out << "  Mất bóng so với gốc: " << missed_ << " frame, thấy bóng mà gốc không thấy: " << extra_ << " frame" << std::endl;
+}
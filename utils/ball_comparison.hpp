@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief So vị trí bóng từng frame (FrameResult::ball) giữa kết quả gốc và kết quả thử
+ *
+ * Dùng chung cho bench_skip (bỏ frame / ROI) và check_accuracy (model / backend thử):
+ * lệch vị trí trên các frame cả 2 có bóng, số frame chỉ 1 bên có bóng.
+ */
+class BallComparison {
+public:
+    /**
+     * @brief Thống kê độ lệch (px)
+     */
+    struct ErrorStats {
+        double mean = 0.0;
+        double p95 = 0.0;
+        double max = 0.0;
+    };
+
+    static ErrorStats summarize(std::vector<double> errors);
+    static std::string format(const ErrorStats& stats);
+
+    /**
+     * @brief Thêm 1 frame (gọi theo đúng thứ tự frame)
+     */
+    void add(const std::optional<cv::Point>& expected, const std::optional<cv::Point>& actual);
+
+    /**
+     * @brief In 2 dòng: lệch vị trí bóng, mất bóng / thừa bóng so với gốc
+     */
+    void print(std::ostream& out) const;
+
+    const std::vector<double>& errors() const { return errors_; }
+    int missed() const { return missed_; }  // Gốc có bóng, bên thử không
+    int extra() const { return extra_; }    // Bên thử có bóng, gốc không
+
+private:
+    std::vector<double> errors_;
+    int missed_ = 0;
+    int extra_ = 0;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Hàng đợi có giới hạn, nhiều producer / nhiều consumer, dùng nối các stage của pipeline
+ * 
+ * push() chặn khi đầy (backpressure), pop() chặn khi rỗng. Sau close(): push() trả false,
+ * pop() vẫn lấy nốt phần tử còn lại rồi trả false.
+ * Kèm metric độ sâu hàng đợi (lấy mẫu mỗi lần push) và thời gian producer bị chặn.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+    
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+    
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (items_.size() >= capacity_ && !closed_) {
+            auto wait_start = std::chrono::steady_clock::now();
+            not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+            push_wait_ += std::chrono::steady_clock::now() - wait_start;
+        }
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        
+        size_t depth = items_.size();
+        depth_sum_ += depth;
+        depth_samples_++;
+        if (depth > max_depth_) {
+            max_depth_ = depth;
+        }
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+    
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+    
+    /**
+     * @brief Không nhận thêm phần tử, đánh thức mọi thread đang chờ
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+    
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+    
+    size_t capacity() const { return capacity_; }
+    
+    /**
+     * @brief Độ sâu lớn nhất / trung bình (ngay sau mỗi push)
+     * Hàng đợi luôn gần đầy = stage phía sau là nút thắt; luôn gần rỗng = stage phía trước chậm
+     */
+    size_t maxDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_depth_;
+    }
+    
+    double averageDepth() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return depth_samples_ > 0 ? static_cast<double>(depth_sum_) / depth_samples_ : 0.0;
+    }
+    
+    /**
+     * @brief Tổng thời gian producer bị chặn vì hàng đợi đầy (ms)
+     */
+    double pushWaitMs() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::chrono::duration<double, std::milli>(push_wait_).count();
+    }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    
+    size_t max_depth_ = 0;
+    uint64_t depth_sum_ = 0;
+    uint64_t depth_samples_ = 0;
+    std::chrono::steady_clock::duration push_wait_{};
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * @brief Thứ tự kênh của frame 3 kênh u8 (tensor của model luôn là RGB như YOLO)
+ *
+ * Nguồn frame báo thứ tự kênh nó giao ra, letterbox / tìm cục bộ đọc theo thứ tự đó.
+ */
+enum class ChannelOrder {
+    BGR,    // OpenCV (VideoCapture, ảnh vẽ annotation)
+    RGB     // Nguồn giao thẳng RGB (VLC RV24) -> không đảo kênh trước khi letterbox
+};
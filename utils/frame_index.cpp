@@ -0,0 +1,195 @@
+#include "frame_index.hpp"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+namespace {
+    const char* INDEX_MAGIC = "FIDX";
+    const int INDEX_VERSION = 2;  // 2: thêm thời điểm sửa của video
+
+    // Kích thước + thời điểm sửa dùng để phát hiện video đã bị thay đổi sau khi build index
+    FrameIndex::FileStamp file_stamp_of(const std::string& path) {
+        FrameIndex::FileStamp stamp;
+        std::error_code ec;
+        uintmax_t size = std::filesystem::file_size(path, ec);
+        if (ec) return stamp;
+        auto mtime = std::filesystem::last_write_time(path, ec);
+        if (ec) return stamp;
+        stamp.size = static_cast<uint64_t>(size);
+        stamp.mtime = static_cast<int64_t>(mtime.time_since_epoch().count());
+        return stamp;
+    }
+
+    // PTS theo thứ tự hiển thị phải hữu hạn và tăng ngặt, nếu không frameAtTime / seek sẽ sai
+    bool strictly_increasing(const std::vector<double>& pts) {
+        for (size_t i = 0; i < pts.size(); i++) {
+            if (!std::isfinite(pts[i]) || (i > 0 && pts[i] <= pts[i - 1])) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+std::string FrameIndex::indexPathFor(const std::string& video_path) {
+    return video_path + ".fidx";
+}
+
+bool FrameIndex::loadOrBuild(const std::string& video_path) {
+    FileStamp stamp = file_stamp_of(video_path);
+    if (stamp.size == 0) {
+        return false;
+    }
+    
+    std::string index_path = indexPathFor(video_path);
+    if (load(index_path, stamp)) {
+        std::cout << "[INFO] Đã load frame index: " << index_path << " (" << frameCount() 
+                  << " frames, " << keyframes_.size() << " keyframes)" << std::endl;
+        return true;
+    }
+    
+    std::cout << "[INFO] Đang build frame index cho: " << video_path << std::endl;
+    if (!build(video_path)) {
+        std::cerr << "[WARNING] Không build được frame index, seek sẽ không chính xác" << std::endl;
+        return false;
+    }
+    
+    if (!save(index_path, stamp)) {
+        std::cerr << "[WARNING] Không lưu được frame index: " << index_path << std::endl;
+    }
+    std::cout << "[INFO] Frame index: " << frameCount() << " frames, " 
+              << keyframes_.size() << " keyframes" << std::endl;
+    return true;
+}
+
+bool FrameIndex::build(const std::string& video_path) {
+    pts_ms_.clear();
+    keyframes_.clear();
+    
+    cv::VideoCapture cap;
+    if (!cap.open(video_path, cv::CAP_FFMPEG)) {
+        return false;
+    }
+    
+    std::vector<double> packet_pts;
+    std::vector<double> keyframe_pts;
+    
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+    // Chỉ đọc packet thô (không decode) -> nhanh, và biết được packet nào là keyframe.
+    // Packet đến theo thứ tự decode nên PTS có thể không tăng dần (B-frame), sẽ sort lại sau.
+    cap.set(cv::CAP_PROP_FORMAT, -1);
+    while (cap.grab()) {
+        double pts = cap.get(cv::CAP_PROP_POS_MSEC);
+        packet_pts.push_back(pts);
+        if (cap.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) > 0) {
+            keyframe_pts.push_back(pts);
+        }
+    }
+#else
+    // OpenCV cũ không báo keyframe: phải decode để lấy PTS, chỉ biết frame 0 là keyframe
+    while (cap.grab()) {
+        packet_pts.push_back(cap.get(cv::CAP_PROP_POS_MSEC));
+    }
+    if (!packet_pts.empty()) {
+        keyframe_pts.push_back(*std::min_element(packet_pts.begin(), packet_pts.end()));
+    }
+#endif
+    cap.release();
+    
+    if (packet_pts.empty()) {
+        return false;
+    }
+    
+    std::sort(packet_pts.begin(), packet_pts.end());
+    // CAP_PROP_POS_MSEC sau grab() ở chế độ packet thô không được mọi backend / container hỗ trợ
+    // (trả 0 hoặc lặp lại giá trị) -> PTS trùng nhau: index vô dụng, không dùng
+    if (!strictly_increasing(packet_pts)) {
+        std::cerr << "[WARNING] Frame index: PTS đọc được không tăng ngặt (" << packet_pts.size()
+                  << " packet), bỏ index" << std::endl;
+        return false;
+    }
+    pts_ms_ = packet_pts;
+    
+    for (double pts : keyframe_pts) {
+        keyframes_.push_back(frameAtTime(pts));
+    }
+    std::sort(keyframes_.begin(), keyframes_.end());
+    keyframes_.erase(std::unique(keyframes_.begin(), keyframes_.end()), keyframes_.end());
+    if (keyframes_.empty() || keyframes_.front() != 0) {
+        keyframes_.insert(keyframes_.begin(), 0);
+    }
+    return true;
+}
+
+bool FrameIndex::load(const std::string& index_path, const FileStamp& expected_stamp) {
+    std::ifstream in(index_path);
+    if (!in.good()) {
+        return false;
+    }
+    
+    std::string magic;
+    int version = 0;
+    FileStamp stamp;
+    size_t frame_count = 0, keyframe_count = 0;
+    in >> magic >> version >> stamp.size >> stamp.mtime >> frame_count >> keyframe_count;
+    if (!in || magic != INDEX_MAGIC || version != INDEX_VERSION || !(stamp == expected_stamp)) {
+        return false;
+    }
+    
+    std::vector<double> pts(frame_count);
+    std::vector<int> keys(keyframe_count);
+    for (auto& p : pts) in >> p;
+    for (auto& k : keys) in >> k;
+    if (!in || !strictly_increasing(pts)) {
+        return false;
+    }
+    
+    pts_ms_.swap(pts);
+    keyframes_.swap(keys);
+    return true;
+}
+
+bool FrameIndex::save(const std::string& index_path, const FileStamp& stamp) const {
+    std::ofstream out(index_path);
+    if (!out.good()) {
+        return false;
+    }
+    
+    out << INDEX_MAGIC << " " << INDEX_VERSION << " " << stamp.size << " " << stamp.mtime << " "
+        << pts_ms_.size() << " " << keyframes_.size() << "\n";
+    out.precision(17);
+    for (double p : pts_ms_) out << p << "\n";
+    for (int k : keyframes_) out << k << "\n";
+    return out.good();
+}
+
+double FrameIndex::ptsMs(int frame_number) const {
+    if (pts_ms_.empty()) return 0.0;
+    frame_number = std::clamp(frame_number, 0, frameCount() - 1);
+    return pts_ms_[frame_number];
+}
+
+int FrameIndex::frameAtTime(double time_ms) const {
+    if (pts_ms_.empty()) return 0;
+    auto it = std::lower_bound(pts_ms_.begin(), pts_ms_.end(), time_ms);
+    if (it == pts_ms_.end()) return frameCount() - 1;
+    int idx = static_cast<int>(it - pts_ms_.begin());
+    if (idx > 0 && std::abs(pts_ms_[idx - 1] - time_ms) < std::abs(*it - time_ms)) {
+        idx--;
+    }
+    return idx;
+}
+
+int FrameIndex::keyframeBefore(int frame_number) const {
+    auto it = std::upper_bound(keyframes_.begin(), keyframes_.end(), frame_number);
+    if (it == keyframes_.begin()) return 0;
+    return *(it - 1);
+}
+
+double FrameIndex::frameDurationMs() const {
+    if (pts_ms_.size() < 2) return 0.0;
+    return (pts_ms_.back() - pts_ms_.front()) / (pts_ms_.size() - 1);
+}
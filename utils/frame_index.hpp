@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Index frame -> timestamp (PTS) và vị trí keyframe của 1 video
+ * 
+ * Được load / build ở lần seek đầu tiên (mở video không chờ index), build chỉ demux không
+ * decode và lưu cạnh video (<video>.fidx). Các lần sau chỉ cần load file index; video đổi
+ * kích thước hoặc thời điểm sửa -> build lại.
+ * Dùng để seek chính xác tới 1 frame và biết trước chi phí seek (số frame phải decode
+ * từ keyframe gần nhất).
+ */
+class FrameIndex {
+public:
+    /**
+     * @brief Load index đã lưu cạnh video, nếu chưa có (hoặc video đã thay đổi) thì build và lưu lại
+     * @param video_path Đường dẫn video
+     * @return true nếu có index hợp lệ
+     */
+    bool loadOrBuild(const std::string& video_path);
+    
+    /**
+     * @brief Build index bằng cách demux toàn bộ video (FFmpeg qua cv::VideoCapture)
+     * @return false nếu không đọc được PTS hợp lệ (PTS sau khi sort không tăng ngặt)
+     */
+    bool build(const std::string& video_path);
+    
+    /**
+     * @brief Kích thước + thời điểm sửa của video, lưu trong index để phát hiện video đã thay đổi
+     */
+    struct FileStamp {
+        uint64_t size = 0;
+        int64_t mtime = 0;
+        bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+    };
+    
+    bool load(const std::string& index_path, const FileStamp& expected_stamp);
+    bool save(const std::string& index_path, const FileStamp& stamp) const;
+    
+    bool empty() const { return pts_ms_.empty(); }
+    int frameCount() const { return static_cast<int>(pts_ms_.size()); }
+    
+    /**
+     * @brief PTS (ms) của frame thứ frame_number (theo thứ tự hiển thị)
+     */
+    double ptsMs(int frame_number) const;
+    
+    /**
+     * @brief Frame có PTS gần nhất với time_ms
+     */
+    int frameAtTime(double time_ms) const;
+    
+    /**
+     * @brief Keyframe gần nhất <= frame_number (decode bắt đầu từ đây khi seek)
+     */
+    int keyframeBefore(int frame_number) const;
+    
+    /**
+     * @brief Khoảng thời gian trung bình giữa 2 frame (ms)
+     */
+    double frameDurationMs() const;
+    
+    static std::string indexPathFor(const std::string& video_path);
+
+private:
+    std::vector<double> pts_ms_;   // Theo thứ tự hiển thị
+    std::vector<int> keyframes_;   // Số thứ tự frame là keyframe (tăng dần)
+};
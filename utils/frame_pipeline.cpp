@@ -0,0 +1,281 @@
+#include "frame_pipeline.hpp"
+#include "metrics.hpp"
+#include "../config.hpp"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <optional>
+
+namespace {
+    const char* const STAGE_NAMES[] = { "decode", "preprocess", "forward", "postprocess", "annotate", "encode" };
+}
+
+FramePipeline::FramePipeline(size_t queue_capacity, size_t batch_size)
+    : queue_capacity_(queue_capacity > 0 ? queue_capacity : 1)
+    , batch_size_(batch_size > 0 ? batch_size : 1)
+{
+    // Hàng đợi phải chứa đủ 1 batch, nếu không stage forward gom batch sẽ chặn stage trước
+    queue_capacity_ = std::max(queue_capacity_, batch_size_);
+}
+
+void FramePipeline::addBusy(Stage stage, std::chrono::steady_clock::duration elapsed, uint64_t frames) {
+    stats_[stage].busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    stats_[stage].frames += frames;
+}
+
+void FramePipeline::forwardLoop(DetectorSession& session, Queue& in, Queue& out) {
+    std::vector<Item> batch;
+    std::vector<cv::Mat> blobs;
+    cv::Mat batch_blob;         // Blob ghép của batch, dùng lại giữa các lần forward
+    std::optional<Item> carry;  // Frame đã lấy ra nhưng không ghép được vào batch trước
+    bool more = true;
+    while ((more || carry) && !failed_) {
+        // Gom tối đa batch_size_ frame (batch cuối có thể thiếu khi nguồn hết).
+        // Frame không inference đi 1 mình; đổi input size -> kết thúc batch để giữ đúng thứ tự
+        batch.clear();
+        Item item;
+        while (batch.size() < batch_size_) {
+            if (carry) {
+                item = std::move(*carry);
+                carry.reset();
+            } else if (!(more = in.pop(item))) {
+                break;
+            }
+            if (!batch.empty() && (item.blob.empty() || item.blob.size[2] != batch[0].blob.size[2])) {
+                carry = std::move(item);
+                break;
+            }
+            batch.push_back(std::move(item));
+            if (batch.back().blob.empty()) {
+                break;
+            }
+        }
+        if (batch.empty()) {
+            break;
+        }
+        
+        if (!batch[0].blob.empty()) {
+            try {
+                auto start = std::chrono::steady_clock::now();
+                if (batch.size() == 1) {
+                    batch[0].outputs = session.run_inference(batch[0].blob);
+                } else {
+                    blobs.clear();
+                    for (const Item& b : batch) {
+                        blobs.push_back(b.blob);
+                    }
+                    std::vector<std::vector<cv::Mat>> outputs = session.run_inference_batch(stack_blobs(blobs, batch_blob));
+                    for (size_t i = 0; i < batch.size(); i++) {
+                        batch[i].outputs = std::move(outputs[i]);
+                    }
+                }
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                addBusy(STAGE_FORWARD, elapsed, batch.size());
+                double per_frame_ms = std::chrono::duration<double, std::milli>(elapsed).count() / batch.size();
+                for (Item& b : batch) {
+                    b.busy_ms = std::max(b.busy_ms, per_frame_ms);
+                }
+                batches_++;
+            } catch (const std::exception& e) {
+                fail(STAGE_NAMES[STAGE_FORWARD], e.what());
+                break;
+            }
+        }
+        
+        // Đẩy ra theo đúng thứ tự đã gom; tensor về pool cho stage preprocess dùng lại
+        for (Item& b : batch) {
+            b.blob.release();
+            b.tensor.reset();
+            if (!out.push(std::move(b))) {
+                more = false;
+                carry.reset();
+                break;
+            }
+        }
+    }
+    out.close();
+}
+
+void FramePipeline::fail(const char* stage_name, const std::string& message) {
+    std::cerr << std::endl << "[ERROR] Pipeline stage " << stage_name << ": " << message << std::endl;
+    failed_ = true;
+    // Đánh thức mọi stage đang chờ để pipeline dừng hẳn
+    for (auto& queue : queues_) {
+        queue->close();
+    }
+}
+
+void FramePipeline::stageLoop(Stage stage, Queue& in, Queue* out, const std::function<void(Item&)>& work) {
+    Item item;
+    while (in.pop(item)) {
+        try {
+            auto start = std::chrono::steady_clock::now();
+            work(item);
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            addBusy(stage, elapsed);
+            item.busy_ms = std::max(item.busy_ms, std::chrono::duration<double, std::milli>(elapsed).count());
+        } catch (const std::exception& e) {
+            fail(STAGE_NAMES[stage], e.what());
+            break;
+        }
+        if (out && !out->push(std::move(item))) {
+            break;
+        }
+    }
+    // Hết input (hoặc lỗi) -> báo stage sau kết thúc
+    if (out) {
+        out->close();
+    }
+}
+
+int FramePipeline::run(DetectorSession& session, FrameSource& source, const cv::Mat& first_frame, const FrameSink& sink) {
+    queues_.clear();
+    for (int i = 0; i < STAGE_COUNT - 1; i++) {
+        queues_.push_back(std::make_unique<Queue>(queue_capacity_));
+    }
+    for (auto& s : stats_) {
+        s.frames = 0;
+        s.busy_ns = 0;
+    }
+    failed_ = false;
+    processed_frames_ = 0;
+    batches_ = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+    
+    // --- Stage 1: decode (đọc lease, copy ra buffer riêng để trả slot cho nguồn ngay) ---
+    std::thread decode_thread([&] {
+        Queue& out = *queues_[STAGE_DECODE];
+        int frame_idx = 0;
+        if (!first_frame.empty()) {
+            Item item;
+            item.frame_idx = frame_idx++;
+            item.frame = first_frame.clone();
+            out.push(std::move(item));
+        }
+        FrameLease lease;
+        while (!failed_) {
+            auto start = std::chrono::steady_clock::now();
+            if (!source.readLease(lease)) {
+                break;
+            }
+            Metrics::record(Metrics::DECODE, std::chrono::steady_clock::now() - start);
+            Item item;
+            item.frame_idx = frame_idx++;
+            item.frame = lease.mat().clone();
+            lease.release();
+            addBusy(STAGE_DECODE, std::chrono::steady_clock::now() - start);
+            if (!out.push(std::move(item))) {
+                break;
+            }
+        }
+        out.close();
+    });
+    
+    // --- Stage 2: preprocess (blob vào tensor của pool) ---
+    // Blob đang sống: hàng đợi preprocess -> forward, batch đang gom, frame carry, frame đang preprocess
+    const ChannelOrder order = source.channelOrder();
+    Letterbox::TensorPool tensor_pool(queue_capacity_ + batch_size_ + 2, Config::MODEL_INPUT_SIZE);
+    std::thread preprocess_thread([&] {
+        stageLoop(STAGE_PREPROCESS, *queues_[STAGE_DECODE], queues_[STAGE_PREPROCESS].get(), [&, order](Item& item) {
+            if (quality_) {
+                item.quality = quality_->qualityFor(item.frame_idx);
+            }
+            if (item.quality.run_inference) {
+                item.tensor = tensor_pool.acquire();
+                item.blob = preprocess_frame(item.frame, *item.tensor, item.quality.input_size, order);
+            }
+        });
+    });
+    
+    // --- Stage 3: DNN forward (gom batch_size_ frame cho 1 lần forward) ---
+    std::thread forward_thread([&] {
+        forwardLoop(session, *queues_[STAGE_PREPROCESS], *queues_[STAGE_FORWARD]);
+    });
+    
+    // --- Stage 4: postprocess + tracking (state tracking -> bắt buộc đúng thứ tự, 1 thread) ---
+    std::thread postprocess_thread([&] {
+        stageLoop(STAGE_POSTPROCESS, *queues_[STAGE_FORWARD], queues_[STAGE_POSTPROCESS].get(), [&session](Item& item) {
+            if (!item.quality.run_inference) {
+                item.result = session.track_skipped(item.frame.size(), item.frame_idx);
+                return;
+            }
+            BallDetections detections = decode_detections(item.outputs, item.frame.size(), item.quality.input_size);
+            item.outputs.clear();
+            item.result = session.track_ball(detections, item.frame.size(), item.frame_idx);
+        });
+    });
+    
+    // --- Stage 5: annotate ---
+    std::thread annotate_thread([&] {
+        stageLoop(STAGE_ANNOTATE, *queues_[STAGE_POSTPROCESS], queues_[STAGE_ANNOTATE].get(), [this](Item& item) {
+            if (annotate_) {
+                annotate_frame(item.frame, item.result, item.quality.detailed_overlay);
+            }
+        });
+    });
+    
+    // --- Stage 6: encode (thread hiện tại) ---
+    int expected_idx = 0;
+    stageLoop(STAGE_ENCODE, *queues_[STAGE_ANNOTATE], nullptr, [&](Item& item) {
+        if (item.frame_idx != expected_idx) {
+            std::cerr << std::endl << "[WARNING] Pipeline: frame " << item.frame_idx
+                      << " ra sai thứ tự (mong đợi " << expected_idx << ")" << std::endl;
+        }
+        expected_idx = item.frame_idx + 1;
+        sink(item.frame, item.frame_idx);
+        processed_frames_++;
+        if (quality_) {
+            quality_->record(item.frame_idx, item.busy_ms);
+        }
+    });
+    
+    decode_thread.join();
+    preprocess_thread.join();
+    forward_thread.join();
+    postprocess_thread.join();
+    annotate_thread.join();
+    
+    wall_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    tensors_allocated_ = tensor_pool.allocated();
+    return failed_ ? -1 : processed_frames_;
+}
+
+double FramePipeline::decodeSeconds() const {
+    return stats_[STAGE_DECODE].busy_ns / 1e9;
+}
+
+void FramePipeline::printReport() const {
+    std::cout << "[INFO] Pipeline (" << STAGE_COUNT << " stage, hàng đợi " << queue_capacity_ << " frame, batch "
+              << batch_size_ << ", " << batches_ << " lần forward, " << tensors_allocated_ << " tensor input):" << std::endl;
+    
+    double sum_ms = 0.0;
+    double slowest_ms = 0.0;
+    int slowest = 0;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        uint64_t frames = stats_[i].frames;
+        double avg_ms = frames > 0 ? stats_[i].busy_ns / 1e6 / frames : 0.0;
+        sum_ms += avg_ms;
+        if (avg_ms > slowest_ms) {
+            slowest_ms = avg_ms;
+            slowest = i;
+        }
+        
+        std::cout << "  " << STAGE_NAMES[i] << ": " << cv::format("%.2f", avg_ms) << "ms/frame";
+        if (i < static_cast<int>(queues_.size())) {
+            // Hàng đợi ra của stage này = hàng đợi vào của stage sau
+            const Queue& q = *queues_[i];
+            std::cout << " | queue -> " << STAGE_NAMES[i + 1] << ": depth TB "
+                      << cv::format("%.1f", q.averageDepth()) << ", max " << q.maxDepth()
+                      << ", chặn " << cv::format("%.0f", q.pushWaitMs()) << "ms";
+        }
+        std::cout << std::endl;
+    }
+    
+    if (wall_seconds_ > 0.0 && processed_frames_ > 0) {
+        std::cout << "  Thông lượng: " << cv::format("%.1f", processed_frames_ / wall_seconds_) << " fps"
+                  << " (tuần tự ~" << cv::format("%.1f", sum_ms > 0.0 ? 1000.0 / sum_ms : 0.0) << " fps"
+                  << ", giới hạn bởi " << STAGE_NAMES[slowest] << " ~"
+                  << cv::format("%.1f", slowest_ms > 0.0 ? 1000.0 / slowest_ms : 0.0) << " fps)" << std::endl;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <atomic>
+#include "frame_source.hpp"
+#include "bounded_queue.hpp"
+#include "quality_controller.hpp"
+#include "../detectors/ball_detector.hpp"
+
+/**
+ * @brief Pipeline xử lý video: mỗi stage 1 thread, nối nhau bằng BoundedQueue
+ * 
+ *   decode -> preprocess -> forward -> postprocess+tracking -> annotate -> encode (sink)
+ * 
+ * Mỗi stage chỉ có 1 thread và hàng đợi là FIFO nên frame ra sink đúng thứ tự vào.
+ * Các stage chạy chồng lên nhau: thông lượng bị giới hạn bởi stage chậm nhất thay vì
+ * tổng thời gian của mọi stage như vòng lặp tuần tự.
+ */
+class FramePipeline {
+public:
+    /**
+     * @brief Nhận frame đã annotate theo đúng thứ tự (chạy trên thread encode)
+     */
+    using FrameSink = std::function<void(const cv::Mat& annotated, int frame_idx)>;
+    
+    enum Stage {
+        STAGE_DECODE = 0,
+        STAGE_PREPROCESS,
+        STAGE_FORWARD,
+        STAGE_POSTPROCESS,
+        STAGE_ANNOTATE,
+        STAGE_ENCODE,
+        STAGE_COUNT
+    };
+    
+    /**
+     * @param queue_capacity Số frame tối đa trong mỗi hàng đợi giữa 2 stage
+     * Với VLC ring, frame được copy ra ngay ở stage decode nên không giữ slot của ring
+     * @param batch_size Số frame mỗi lần forward (stage forward gom đủ batch rồi mới chạy)
+     */
+    explicit FramePipeline(size_t queue_capacity, size_t batch_size = 1);
+    
+    /**
+     * @brief Chạy pipeline tới khi nguồn hết frame (chặn cho tới khi mọi stage xong)
+     * @param session Session của video này (forward và tracking chạy trên 2 thread khác nhau
+     * nhưng mỗi phần state của session chỉ 1 thread chạm tới)
+     * @param source Nguồn đã mở
+     * @param first_frame Frame 0 đã đọc trước (có thể rỗng)
+     * @param sink Nơi nhận frame đã annotate (ghi video, in tiến độ...)
+     * @return Số frame đã đi hết pipeline, -1 nếu có stage bị lỗi
+     */
+    int run(DetectorSession& session, FrameSource& source, const cv::Mat& first_frame, const FrameSink& sink);
+    
+    /**
+     * @brief Điều chỉnh chất lượng theo tải (nullptr: luôn chất lượng cao nhất)
+     * Mức được chọn ở stage preprocess cho từng frame; thời gian của stage chậm nhất mà
+     * frame đi qua được báo lại cho controller ở stage encode.
+     */
+    void setQualityController(QualityController* controller) { quality_ = controller; }
+    
+    /**
+     * @brief false: stage annotate chỉ chuyển frame đi (không ghi video thì không cần vẽ),
+     * sink nhận frame chưa vẽ
+     */
+    void setAnnotate(bool enabled) { annotate_ = enabled; }
+    
+    /**
+     * @brief In thời gian trung bình mỗi stage, độ sâu hàng đợi và thông lượng
+     */
+    void printReport() const;
+    
+    /**
+     * @brief Tổng thời gian stage decode chờ nguồn (giây)
+     */
+    double decodeSeconds() const;
+
+private:
+    struct Item {
+        int frame_idx = 0;
+        cv::Mat frame;                 // Frame (sở hữu riêng), được annotate tại chỗ
+        cv::Mat blob;                  // Trỏ vào `tensor`
+        std::shared_ptr<Letterbox::InputTensor> tensor;  // Lấy từ pool, về pool khi forward thả
+        std::vector<cv::Mat> outputs;
+        FrameResult result;
+        ProcessingQuality quality;     // Mức chất lượng của frame này (input size, có inference không...)
+        double busy_ms = 0.0;          // Thời gian của stage chậm nhất (không tính decode)
+    };
+    using Queue = BoundedQueue<Item>;
+    
+    struct StageStats {
+        std::atomic<uint64_t> frames{0};
+        std::atomic<int64_t> busy_ns{0};
+    };
+    
+    /**
+     * @brief Vòng lặp chung của 1 stage giữa 2 hàng đợi: pop -> work -> push
+     */
+    void stageLoop(Stage stage, Queue& in, Queue* out, const std::function<void(Item&)>& work);
+    void addBusy(Stage stage, std::chrono::steady_clock::duration elapsed, uint64_t frames = 1);
+    void forwardLoop(DetectorSession& session, Queue& in, Queue& out);
+    void fail(const char* stage_name, const std::string& message);
+    
+    size_t queue_capacity_;
+    size_t batch_size_;
+    std::atomic<uint64_t> batches_{0};
+    std::vector<std::unique_ptr<Queue>> queues_;  // queues_[i]: đầu vào của stage i+1
+    StageStats stats_[STAGE_COUNT];
+    std::atomic<bool> failed_{false};
+    QualityController* quality_ = nullptr;
+    bool annotate_ = true;
+    double wall_seconds_ = 0.0;
+    size_t tensors_allocated_ = 0;  // Số tensor input của pool preprocess (cấp phát sẵn + thêm khi hết)
+    int processed_frames_ = 0;
+};
@@ -0,0 +1,92 @@
+#include "frame_source.hpp"
+#include "../config.hpp"
+#include "opencv_source.hpp"
+#include "image_dir_source.hpp"
+#include "synthetic_source.hpp"
+#ifdef HAVE_LIBVLC
+#include "vlc_reader.hpp"
+#endif
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+bool FrameSource::readLease(FrameLease& lease) {
+    cv::Mat frame;
+    if (!read(frame)) {
+        lease.release();
+        return false;
+    }
+    int64_t frame_number = static_cast<int64_t>(get(cv::CAP_PROP_POS_FRAMES)) - 1;
+    lease = FrameLease(frame, frame_number);
+    return true;
+}
+
+cv::Size FrameSource::fitInto(const cv::Size& native, const cv::Size& box) {
+    if (box.empty() || native.empty()) {
+        return native;
+    }
+    // Cùng 1 tỉ lệ cho 2 chiều -> bóng không bị kéo méo, ngưỡng pixel của tracking vẫn đẳng hướng
+    double scale = std::min(1.0, std::min(static_cast<double>(box.width) / native.width,
+                                          static_cast<double>(box.height) / native.height));
+    return cv::Size(std::max(1, static_cast<int>(std::lround(native.width * scale))),
+                    std::max(1, static_cast<int>(std::lround(native.height * scale))));
+}
+
+void FrameSource::scaleToOutput(cv::Mat& frame) const {
+    if (output_size_.empty() || frame.empty()) {
+        return;
+    }
+    cv::Size target = fitInto(frame.size(), output_size_);
+    if (target == frame.size()) {
+        return;
+    }
+    // INTER_LINEAR giống letterbox trong detector -> input của model không đổi so với resize ở đó
+    cv::Mat scaled;
+    cv::resize(frame, scaled, target, 0, 0, cv::INTER_LINEAR);
+    frame = scaled;
+}
+
+std::unique_ptr<FrameSource> createFrameSource(const std::string& backend,
+                                               const FrameSourceOptions& options) {
+    if (backend == "vlc") {
+#ifdef HAVE_LIBVLC
+        auto reader = std::make_unique<VLCVideoReader>();
+        VLCVideoReader::DecodeMode decode_mode = VLCVideoReader::DecodeMode::Stepped;
+        if (Config::VLC_RING_MODE) {
+            decode_mode = options.offline_decode ? VLCVideoReader::DecodeMode::Offline
+                                                 : VLCVideoReader::DecodeMode::Ring;
+        }
+        reader->setDecodeMode(decode_mode, Config::VLC_RING_SLOTS);
+        if (options.drop_policy == "oldest") {
+            reader->setDropPolicy(VLCVideoReader::DropPolicy::DropOldest);
+        } else if (options.drop_policy == "latest") {
+            reader->setDropPolicy(VLCVideoReader::DropPolicy::KeepLatest);
+        } else if (options.drop_policy == "block") {
+            reader->setDropPolicy(VLCVideoReader::DropPolicy::Block);
+        } else if (options.drop_policy != "auto") {
+            std::cerr << "[WARNING] Drop policy không hợp lệ: " << options.drop_policy
+                      << ", dùng mặc định theo chế độ decode" << std::endl;
+        }
+        reader->setPixelLayout(options.rgb_frames ? VLCVideoReader::PixelLayout::RGB : VLCVideoReader::PixelLayout::BGR);
+        reader->setUseFrameIndex(Config::VLC_FRAME_INDEX);
+        reader->setOutputSize(options.output_size);
+        return reader;
+#else
+        std::cerr << "[ERROR] Bản build này không có libVLC, hãy dùng backend khác (opencv/images/synthetic)" << std::endl;
+        return nullptr;
+#endif
+    }
+    std::unique_ptr<FrameSource> source;
+    if (backend == "opencv") {
+        source = std::make_unique<OpenCVFrameSource>();
+    } else if (backend == "images") {
+        source = std::make_unique<ImageDirFrameSource>();
+    } else if (backend == "synthetic") {
+        source = std::make_unique<SyntheticFrameSource>();
+    } else {
+        std::cerr << "[ERROR] Không có frame source backend: " << backend << std::endl;
+        return nullptr;
+    }
+    source->setOutputSize(options.output_size);
+    return source;
+}
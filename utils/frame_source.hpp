@@ -0,0 +1,144 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include "channel_order.hpp"
+
+/**
+ * @brief Frame "mượn" từ nguồn video
+ * 
+ * Với VLCVideoReader, mat() là header trỏ thẳng vào buffer VLC đã decode vào (zero-copy).
+ * Lease có thể copy (đếm tham chiếu); buffer được trả về pool khi bản copy cuối cùng bị
+ * hủy hoặc release(). Không giữ cv::Mat lấy từ mat() lâu hơn lease, vì buffer sẽ được
+ * dùng lại cho frame khác.
+ */
+class FrameLease {
+public:
+    FrameLease() = default;
+    FrameLease(const cv::Mat& image, int64_t frame_number, std::shared_ptr<void> hold = nullptr)
+        : image_(image), frame_number_(frame_number), hold_(std::move(hold)) {}
+    
+    const cv::Mat& mat() const { return image_; }
+    bool empty() const { return image_.empty(); }
+    
+    /**
+     * @brief Số thứ tự frame trong video (tính cả frame bị bỏ, chính xác sau seek)
+     */
+    int64_t frameNumber() const { return frame_number_; }
+    
+    void release() {
+        image_.release();
+        hold_.reset();
+        frame_number_ = -1;
+    }
+
+private:
+    cv::Mat image_;
+    int64_t frame_number_ = -1;
+    std::shared_ptr<void> hold_;  // Deleter trả buffer về pool
+};
+
+/**
+ * @brief Interface chung cho mọi nguồn frame (VLC, OpenCV/FFmpeg, thư mục ảnh, giả lập)
+ * 
+ * API giống cv::VideoCapture để main.cpp và các detector không phụ thuộc backend cụ thể.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+    
+    /**
+     * @brief Mở nguồn
+     * @param path Đường dẫn video / thư mục ảnh / spec giả lập (tùy backend)
+     */
+    virtual bool open(const std::string& path) = 0;
+    virtual bool isOpened() const = 0;
+    
+    /**
+     * @brief Đọc frame tiếp theo (thứ tự kênh theo channelOrder(), do caller sở hữu)
+     */
+    virtual bool read(cv::Mat& frame) = 0;
+    
+    /**
+     * @brief Đọc frame tiếp theo dưới dạng lease (thứ tự kênh theo channelOrder())
+     * Mặc định: đọc vào buffer mới rồi bọc thành lease. Backend hỗ trợ zero-copy sẽ override.
+     */
+    virtual bool readLease(FrameLease& lease);
+    
+    virtual double get(int prop) const = 0;
+    virtual bool set(int prop, double value) = 0;
+    virtual void release() = 0;
+    
+    /**
+     * @brief Tên backend để in log / so sánh benchmark
+     */
+    virtual std::string name() const = 0;
+    
+    /**
+     * @brief Thứ tự kênh của frame read() / readLease(): BGR, trừ khi backend được yêu cầu
+     * giao RGB (xem FrameSourceOptions::rgb_frames)
+     */
+    virtual ChannelOrder channelOrder() const { return ChannelOrder::BGR; }
+    
+    /**
+     * @brief Yêu cầu nguồn thu nhỏ frame vào khung size, giữ tỉ lệ (gọi trước open())
+     * Ví dụ khung MODEL_INPUT_SIZE x MODEL_INPUT_SIZE: cạnh dài của frame = input của model, letterbox
+     * trong detector chỉ còn đệm. VLC scale ngay trong decoder; các backend khác resize ngay sau khi đọc.
+     * CAP_PROP_FRAME_WIDTH/HEIGHT trả về kích thước sau scale. Size rỗng = kích thước gốc.
+     */
+    virtual void setOutputSize(const cv::Size& size) { output_size_ = size; }
+    cv::Size outputSize() const { return output_size_; }
+
+    /**
+     * @brief Kích thước gốc của video trước khi thu nhỏ (= CAP_PROP_FRAME_WIDTH/HEIGHT nếu không có
+     * output size). Detector đưa kết quả về tọa độ này để ngưỡng pixel không đổi theo output size
+     */
+    virtual cv::Size nativeFrameSize() const {
+        return cv::Size(static_cast<int>(get(cv::CAP_PROP_FRAME_WIDTH)), static_cast<int>(get(cv::CAP_PROP_FRAME_HEIGHT)));
+    }
+
+    /**
+     * @brief Kích thước của frame native sau khi thu nhỏ vào khung box (giữ tỉ lệ, không phóng to)
+     */
+    static cv::Size fitInto(const cv::Size& native, const cv::Size& box);
+    
+    FrameSource& operator>>(cv::Mat& frame) {
+        read(frame);
+        return *this;
+    }
+
+protected:
+    /**
+     * @brief Thu nhỏ frame vào khung output_size_ (cho backend không scale được khi decode)
+     */
+    void scaleToOutput(cv::Mat& frame) const;
+    
+    /**
+     * @brief Kích thước frame trả ra cho CAP_PROP_FRAME_WIDTH/HEIGHT
+     */
+    cv::Size outputFrameSize(const cv::Size& native) const {
+        return output_size_.empty() ? native : fitInto(native, output_size_);
+    }
+    
+    cv::Size output_size_;
+};
+
+/**
+ * @brief Tùy chọn khi tạo nguồn frame (phần lớn chỉ áp dụng cho VLC)
+ */
+struct FrameSourceOptions {
+    bool offline_decode = true;  // VLC: decode nhanh nhất có thể thay vì theo fps của file
+    cv::Size output_size;        // Rỗng: kích thước gốc, ngược lại: khung thu nhỏ khi decode, giữ tỉ lệ (xem setOutputSize)
+    std::string drop_policy = "auto";  // VLC: "oldest", "latest", "block" hoặc "auto" (theo chế độ decode)
+    bool rgb_frames = false;     // VLC: giao frame RGB (thứ tự kênh của model), bỏ đảo kênh mỗi frame. Chỉ khi không vẽ / ghi video
+};
+
+/**
+ * @brief Tạo nguồn frame theo tên backend
+ * @param backend "vlc", "opencv", "images" hoặc "synthetic"
+ * @return nullptr nếu backend không tồn tại hoặc không được build (ví dụ thiếu libVLC)
+ */
+std::unique_ptr<FrameSource> createFrameSource(const std::string& backend,
+                                               const FrameSourceOptions& options = FrameSourceOptions());
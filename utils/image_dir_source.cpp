@@ -0,0 +1,99 @@
+#include "image_dir_source.hpp"
+#include "../config.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    bool is_image_file(const std::string& path) {
+        size_t dot = path.find_last_of('.');
+        if (dot == std::string::npos) return false;
+        std::string ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        return ext == "jpg" || ext == "jpeg" || ext == "png" || ext == "bmp";
+    }
+}
+
+bool ImageDirFrameSource::open(const std::string& path) {
+    release();
+    
+    std::vector<std::string> all_files;
+    cv::glob(path, all_files, false);
+    for (const auto& file : all_files) {
+        if (is_image_file(file)) {
+            files_.push_back(file);
+        }
+    }
+    std::sort(files_.begin(), files_.end());
+    
+    if (files_.empty()) {
+        std::cerr << "[ERROR] Không có ảnh nào trong thư mục: " << path << std::endl;
+        return false;
+    }
+    
+    // Kích thước lấy từ ảnh đầu tiên
+    cv::Mat first = cv::imread(files_[0]);
+    if (first.empty()) {
+        std::cerr << "[ERROR] Không đọc được ảnh: " << files_[0] << std::endl;
+        files_.clear();
+        return false;
+    }
+    frame_size_ = cv::Size(first.cols, first.rows);
+    fps_ = Config::IMAGE_SOURCE_FPS;
+    return true;
+}
+
+bool ImageDirFrameSource::isOpened() const {
+    return !files_.empty();
+}
+
+bool ImageDirFrameSource::read(cv::Mat& frame) {
+    if (position_ >= files_.size()) {
+        return false;
+    }
+    frame = cv::imread(files_[position_++]);
+    scaleToOutput(frame);
+    return !frame.empty();
+}
+
+double ImageDirFrameSource::get(int prop) const {
+    if (!isOpened()) {
+        return -1.0;
+    }
+    switch (prop) {
+        case cv::CAP_PROP_FRAME_WIDTH:
+            return outputFrameSize(frame_size_).width;
+        case cv::CAP_PROP_FRAME_HEIGHT:
+            return outputFrameSize(frame_size_).height;
+        case cv::CAP_PROP_FPS:
+            return fps_;
+        case cv::CAP_PROP_FRAME_COUNT:
+            return static_cast<double>(files_.size());
+        case cv::CAP_PROP_POS_FRAMES:
+            return static_cast<double>(position_);
+        case cv::CAP_PROP_POS_MSEC:
+            return position_ * 1000.0 / fps_;
+        default:
+            return -1.0;
+    }
+}
+
+bool ImageDirFrameSource::set(int prop, double value) {
+    if (!isOpened()) {
+        return false;
+    }
+    switch (prop) {
+        case cv::CAP_PROP_POS_FRAMES:
+            position_ = static_cast<size_t>(std::clamp(value, 0.0, static_cast<double>(files_.size())));
+            return true;
+        case cv::CAP_PROP_POS_MSEC:
+            return set(cv::CAP_PROP_POS_FRAMES, value / 1000.0 * fps_);
+        default:
+            return false;
+    }
+}
+
+void ImageDirFrameSource::release() {
+    files_.clear();
+    position_ = 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "frame_source.hpp"
+#include <vector>
+
+/**
+ * @brief Nguồn frame từ thư mục ảnh (jpg/png/bmp), đọc theo thứ tự tên file
+ */
+class ImageDirFrameSource : public FrameSource {
+public:
+    /**
+     * @param path Thư mục chứa ảnh
+     */
+    bool open(const std::string& path) override;
+    bool isOpened() const override;
+    bool read(cv::Mat& frame) override;
+    double get(int prop) const override;
+    cv::Size nativeFrameSize() const override { return frame_size_; }
+    bool set(int prop, double value) override;
+    void release() override;
+    std::string name() const override { return "images"; }
+
+private:
+    std::vector<std::string> files_;
+    size_t position_ = 0;
+    cv::Size frame_size_;
+    double fps_ = 30.0;
+};
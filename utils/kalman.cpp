@@ -3,12 +3,8 @@
 
 namespace KalmanUtils {
 
-    // --- Biến nội bộ (ẩn trong file .cpp này) ---
-    static cv::KalmanFilter kf;
-    static bool initialized = false;
-
     // Hàm nội bộ để khởi tạo (tương đương def create_kalman)
-    void create_kalman(float start_x, float start_y) {
+    void BallKalman::create_kalman(float start_x, float start_y) {
         // 4 biến trạng thái (x, y, dx, dy), 2 biến đo lường (x, y)
         kf = cv::KalmanFilter(4, 2, 0, CV_32F);
 
@@ -44,7 +40,7 @@ namespace KalmanUtils {
         initialized = true;
     }
 
-    cv::Mat update_kalman(float cx, float cy) {
+    cv::Mat BallKalman::update_kalman(float cx, float cy) {
         // Nếu chưa có Kalman, tạo mới ngay lập tức
         if (!initialized) {
             create_kalman(cx, cy);
@@ -63,7 +59,7 @@ namespace KalmanUtils {
         return prediction;
     }
 
-    std::optional<cv::Mat> try_predict() {
+    std::optional<cv::Mat> BallKalman::try_predict() {
         if (!initialized) {
             return std::nullopt;
         }
@@ -71,13 +67,13 @@ namespace KalmanUtils {
         return prediction;
     }
 
-    bool is_kfExist() {
+    bool BallKalman::is_kfExist() const {
         return initialized;
     }
 
-    void reset_kalman() {
+    void BallKalman::reset_kalman() {
         initialized = false;
-        // Không cần delete kf vì nó là object tĩnh, 
+        // Không cần giải phóng kf, 
         // lần tới gọi create_kalman nó sẽ được ghi đè.
     }
 
@@ -7,25 +7,37 @@
 namespace KalmanUtils {
 
     /**
-     * Cập nhật bộ lọc Kalman với tọa độ đo được (cx, cy).
-     * Nếu Kalman chưa tồn tại, nó sẽ tự khởi tạo.
+     * @brief Bộ lọc Kalman theo dõi 1 quả bóng (mỗi DetectorSession có 1 bộ lọc riêng)
      */
-    cv::Mat update_kalman(float cx, float cy);
+    class BallKalman {
+    public:
+        /**
+         * Cập nhật bộ lọc Kalman với tọa độ đo được (cx, cy).
+         * Nếu Kalman chưa tồn tại, nó sẽ tự khởi tạo.
+         */
+        cv::Mat update_kalman(float cx, float cy);
 
-    /**
-     * Cố gắng dự đoán vị trí tiếp theo mà không cần dữ liệu đo mới.
-     * Trả về std::nullopt nếu Kalman chưa được khởi tạo.
-     */
-    std::optional<cv::Mat> try_predict();
+        /**
+         * Cố gắng dự đoán vị trí tiếp theo mà không cần dữ liệu đo mới.
+         * Trả về std::nullopt nếu Kalman chưa được khởi tạo.
+         */
+        std::optional<cv::Mat> try_predict();
 
-    /**
-     * Kiểm tra xem bộ lọc Kalman đã được khởi tạo hay chưa.
-     */
-    bool is_kfExist();
+        /**
+         * Kiểm tra xem bộ lọc Kalman đã được khởi tạo hay chưa.
+         */
+        bool is_kfExist() const;
 
-    /**
-     * Reset bộ lọc (hủy trạng thái hiện tại).
-     */
-    void reset_kalman();
+        /**
+         * Reset bộ lọc (hủy trạng thái hiện tại).
+         */
+        void reset_kalman();
+
+    private:
+        void create_kalman(float start_x, float start_y);
+
+        cv::KalmanFilter kf;
+        bool initialized = false;
+    };
 
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "letterbox.hpp"
+#include "../config.hpp"
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace Letterbox {
+
+    namespace {
+        const float INV_255 = 1.0f / 255.0f;
+
+#if CV_SIMD128
+        // 16 giá trị u8 -> 16 float đã chia 255
+        inline void store_scaled(float* dst, const cv::v_uint8x16& v, const cv::v_float32x4& k) {
+            cv::v_uint16x8 lo, hi;
+            cv::v_expand(v, lo, hi);
+            cv::v_uint32x4 q0, q1, q2, q3;
+            cv::v_expand(lo, q0, q1);
+            cv::v_expand(hi, q2, q3);
+            cv::v_store(dst, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q0)) * k);
+            cv::v_store(dst + 4, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q1)) * k);
+            cv::v_store(dst + 8, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q2)) * k);
+            cv::v_store(dst + 12, cv::v_cvt_f32(cv::v_reinterpret_as_s32(q3)) * k);
+        }
+#endif
+
+        // 1 hàng BGR / RGB xen kẽ -> 3 hàng R, G, B riêng (swap + scale + HWC -> CHW cùng lúc)
+        void convert_row(const uchar* src, float* r, float* g, float* b, int width, ChannelOrder order) {
+            if (order == ChannelOrder::RGB) {
+                std::swap(r, b);  // Kênh 0 của src là R -> ghi vào plane R
+            }
+            int x = 0;
+#if CV_SIMD128
+            const cv::v_float32x4 k = cv::v_setall_f32(INV_255);
+            for (; x <= width - 16; x += 16) {
+                cv::v_uint8x16 vb, vg, vr;
+                cv::v_load_deinterleave(src + 3 * x, vb, vg, vr);
+                store_scaled(r + x, vr, k);
+                store_scaled(g + x, vg, k);
+                store_scaled(b + x, vb, k);
+            }
+#endif
+            for (; x < width; x++) {
+                b[x] = src[3 * x] * INV_255;
+                g[x] = src[3 * x + 1] * INV_255;
+                r[x] = src[3 * x + 2] * INV_255;
+            }
+        }
+
+        bool same_layout(const Transform& a, const Transform& b) {
+            return a.input_size == b.input_size && a.scaled == b.scaled && a.pad_x == b.pad_x && a.pad_y == b.pad_y;
+        }
+    }
+
+    cv::Rect Transform::toFrame(float cx, float cy, float w, float h) const {
+        float left = (cx - 0.5f * w - pad_x) / scale;
+        float top = (cy - 0.5f * h - pad_y) / scale;
+        return cv::Rect(static_cast<int>(left), static_cast<int>(top), static_cast<int>(w / scale), static_cast<int>(h / scale));
+    }
+
+    Transform compute(const cv::Size& frame_size, int input_size) {
+        Transform t;
+        t.input_size = input_size;
+        t.scale = std::min(static_cast<float>(input_size) / frame_size.width, static_cast<float>(input_size) / frame_size.height);
+        t.scaled.width = std::min(input_size, static_cast<int>(std::lround(frame_size.width * t.scale)));
+        t.scaled.height = std::min(input_size, static_cast<int>(std::lround(frame_size.height * t.scale)));
+        t.pad_x = (input_size - t.scaled.width) / 2;
+        t.pad_y = (input_size - t.scaled.height) / 2;
+        return t;
+    }
+
+    cv::Mat image(const cv::Mat& frame, int input_size) {
+        Transform t = compute(frame.size(), input_size);
+        cv::Mat resized;
+        cv::resize(frame, resized, t.scaled, 0, 0, cv::INTER_LINEAR);
+        cv::Mat boxed;
+        cv::copyMakeBorder(resized, boxed, t.pad_y, input_size - t.scaled.height - t.pad_y,
+                           t.pad_x, input_size - t.scaled.width - t.pad_x,
+                           cv::BORDER_CONSTANT, cv::Scalar::all(Config::LETTERBOX_PAD_VALUE));
+        return boxed;
+    }
+
+    void InputTensor::reserve(int count, int input_size) {
+        const size_t slot_floats = 3 * static_cast<size_t>(input_size) * input_size;
+        if (buffer_.empty() || buffer_.total() < count * slot_floats) {
+            buffer_.create(1, static_cast<int>(count * slot_floats), CV_32F);
+            layout_.clear();  // Bộ nhớ mới -> mọi slot phải ghi lại phần đệm
+        }
+        if (input_size != input_size_) {
+            input_size_ = input_size;
+            layout_.clear();  // Slot dời chỗ trong buffer
+        }
+        layout_.resize(buffer_.total() / slot_floats);
+    }
+
+    cv::Mat InputTensor::blob(int count) const {
+        int sizes[] = { count, 3, input_size_, input_size_ };
+        int floats = count * 3 * input_size_ * input_size_;
+        return buffer_.colRange(0, floats).reshape(1, 4, sizes);
+    }
+
+    Transform InputTensor::fill(const cv::Mat& frame, int input_size, int index, ChannelOrder order) {
+        CV_Assert(frame.type() == CV_8UC3);
+        reserve(index + 1, input_size);
+        Transform t = compute(frame.size(), input_size);
+
+        const size_t plane = static_cast<size_t>(input_size) * input_size;
+        float* slot = buffer_.ptr<float>() + index * 3 * plane;
+        if (!same_layout(layout_[index], t)) {
+            std::fill(slot, slot + 3 * plane, Config::LETTERBOX_PAD_VALUE * INV_255);
+            layout_[index] = t;
+        }
+
+        // Resize dùng cv::resize (đã tối ưu SIMD) vào buffer dùng lại; frame đã đúng kích thước thì bỏ qua
+        const cv::Mat* image = &frame;
+        if (t.scaled != frame.size()) {
+            cv::resize(frame, resized_, t.scaled, 0, 0, cv::INTER_LINEAR);
+            image = &resized_;
+        }
+
+        float* r_plane = slot + static_cast<size_t>(t.pad_y) * input_size + t.pad_x;
+        float* g_plane = r_plane + plane;
+        float* b_plane = g_plane + plane;
+        const cv::Mat& src = *image;
+        cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& rows) {
+            for (int y = rows.start; y < rows.end; y++) {
+                size_t offset = static_cast<size_t>(y) * input_size;
+                convert_row(src.ptr<uchar>(y), r_plane + offset, g_plane + offset, b_plane + offset, src.cols, order);
+            }
+        });
+        return t;
+    }
+
+    TensorPool::TensorPool(size_t count, int input_size)
+        : state_(std::make_shared<State>())
+    {
+        for (size_t i = 0; i < count; i++) {
+            auto tensor = std::make_unique<InputTensor>();
+            tensor->reserve(1, input_size);
+            state_->free.push_back(std::move(tensor));
+        }
+        state_->allocated = count;
+    }
+
+    std::shared_ptr<InputTensor> TensorPool::acquire() {
+        std::unique_ptr<InputTensor> tensor;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (!state_->free.empty()) {
+                tensor = std::move(state_->free.back());
+                state_->free.pop_back();
+            } else {
+                state_->allocated++;
+            }
+        }
+        if (!tensor) {
+            tensor = std::make_unique<InputTensor>();
+        }
+        // Deleter giữ state -> tensor trả về đúng pool dù pipeline đã xong
+        std::shared_ptr<State> state = state_;
+        return std::shared_ptr<InputTensor>(tensor.release(), [state](InputTensor* released) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->free.emplace_back(released);
+        });
+    }
+
+    size_t TensorPool::allocated() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->allocated;
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include "channel_order.hpp"
+
+/**
+ * @brief Tiền xử lý input YOLO kiểu letterbox: scale giữ tỉ lệ, phần thừa đệm màu xám
+ *
+ * Thay cho blobFromImage (ép frame về hình vuông -> bóng bị méo). Đổi BGR -> RGB, u8 -> f32 (/255)
+ * và HWC -> CHW gộp trong 1 lần duyệt SIMD, ghi thẳng vào tensor cấp phát sẵn.
+ */
+namespace Letterbox {
+
+    /**
+     * @brief Vị trí frame trong input vuông input_size x input_size
+     */
+    struct Transform {
+        int input_size = 0;
+        float scale = 1.0f;     // Pixel frame -> pixel input
+        int pad_x = 0;          // Frame sau khi scale nằm tại (pad_x, pad_y), kích thước `scaled`
+        int pad_y = 0;
+        cv::Size scaled;
+
+        /**
+         * @brief Box (cx, cy, w, h) theo input của model -> box theo frame gốc
+         */
+        cv::Rect toFrame(float cx, float cy, float w, float h) const;
+    };
+
+    /**
+     * @brief Chỉ phụ thuộc kích thước frame và input_size -> decode tính lại được mà không cần lưu
+     */
+    Transform compute(const cv::Size& frame_size, int input_size);
+
+    /**
+     * @brief Ảnh BGR u8 input_size x input_size đã letterbox (để lưu / xem, ví dụ ảnh calibration)
+     */
+    cv::Mat image(const cv::Mat& frame, int input_size);
+
+    /**
+     * @brief Tensor input [N, 3, S, S] float32 cấp phát 1 lần, dùng lại mỗi frame
+     *
+     * Buffer chỉ cấp phát lại khi cần nhiều hơn (đổi qua lại input 640 / 320 không cấp phát).
+     * Phần đệm của mỗi slot chỉ ghi lại khi vị trí frame trong slot thay đổi (đổi kích thước
+     * frame / input_size).
+     * Blob trả về dùng chung bộ nhớ với tensor: nội dung đổi ở lần fill() kế tiếp.
+     */
+    class InputTensor {
+    public:
+        /**
+         * @brief Letterbox 1 frame CV_8UC3 (có thể là ROI không liên tục) vào slot `index`
+         * @param order Thứ tự kênh của frame; đảo kênh gộp trong lần duyệt ghi tensor, không tốn thêm
+         */
+        Transform fill(const cv::Mat& frame, int input_size, int index = 0, ChannelOrder order = ChannelOrder::BGR);
+
+        /**
+         * @brief Cấp phát cho `count` slot ở input_size (không làm gì nếu đã đủ)
+         */
+        void reserve(int count, int input_size);
+
+        /**
+         * @brief [count, 3, S, S] trên `count` slot đầu tiên (không copy)
+         */
+        cv::Mat blob(int count = 1) const;
+
+    private:
+        cv::Mat buffer_;                    // 1 hàng float, slot i bắt đầu tại i * 3 * S * S
+        int input_size_ = 0;
+        cv::Mat resized_;                   // Frame sau khi resize (u8), dùng lại giữa các frame
+        std::vector<Transform> layout_;     // Vị trí frame đã ghi phần đệm cho từng slot
+    };
+
+    /**
+     * @brief Pool InputTensor cấp phát sẵn cho nơi giữ nhiều blob cùng lúc (pipeline)
+     *
+     * acquire() trả tensor đang rảnh, tensor tự quay về pool khi shared_ptr cuối cùng được thả
+     * (kể cả sau khi pool bị hủy). Hết tensor rảnh thì cấp phát thêm thay vì chặn -> pool tự
+     * dừng ở số blob tối đa đang nằm trong pipeline.
+     */
+    class TensorPool {
+    public:
+        /**
+         * @param count Số tensor cấp phát sẵn (1 slot mỗi tensor)
+         * @param input_size Kích thước input cấp phát sẵn
+         */
+        TensorPool(size_t count, int input_size);
+
+        std::shared_ptr<InputTensor> acquire();
+
+        /**
+         * @brief Tổng số tensor đã cấp phát (sẵn + thêm khi hết)
+         */
+        size_t allocated() const;
+
+    private:
+        struct State {
+            mutable std::mutex mutex;
+            std::vector<std::unique_ptr<InputTensor>> free;
+            size_t allocated = 0;
+        };
+        std::shared_ptr<State> state_;
+    };
+}
@@ -0,0 +1,217 @@
+#include "metrics.hpp"
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace Metrics {
+
+    namespace {
+        const char* const STAGE_NAMES[STAGE_COUNT] = {
+            "decode", "preprocess", "forward", "parse", "nms",
+            "tracking", "local_search", "kalman", "bounce", "draw", "encode"
+        };
+
+        std::atomic<bool> g_enabled{true};
+        Histogram g_histograms[STAGE_COUNT];
+        const std::chrono::steady_clock::time_point g_start = std::chrono::steady_clock::now();
+
+        double to_us(double ns) {
+            return ns / 1000.0;
+        }
+
+        // Ghi vào file tạm rồi rename: tool đọc định kỳ không bao giờ thấy file ghi dở
+        bool write_atomically(const std::string& path, const std::string& content) {
+            std::string tmp_path = path + ".tmp";
+            {
+                std::ofstream out(tmp_path, std::ios::trunc);
+                if (!out) {
+                    return false;
+                }
+                out << content;
+                if (!out) {
+                    return false;
+                }
+            }
+            std::remove(path.c_str());  // Windows: rename không ghi đè file đã có
+            return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+        }
+    }
+
+    const char* stageName(Stage stage) {
+        return (stage >= 0 && stage < STAGE_COUNT) ? STAGE_NAMES[stage] : "unknown";
+    }
+
+    int Histogram::bucketIndex(uint64_t ns) {
+        if (ns < static_cast<uint64_t>(2 * SUB_BUCKETS)) {
+            return static_cast<int>(ns);
+        }
+#if defined(__GNUC__) || defined(__clang__)
+        int exponent = 63 - __builtin_clzll(ns);
+#else
+        int exponent = 0;
+        for (uint64_t v = ns; v > 1; v >>= 1) {
+            exponent++;
+        }
+#endif
+        if (exponent > MAX_EXPONENT) {
+            return BUCKET_COUNT - 1;
+        }
+        // exponent >= SUB_BITS + 1: lấy SUB_BITS bit ngay sau bit cao nhất làm sub-bucket
+        int sub = static_cast<int>((ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+        return 2 * SUB_BUCKETS + (exponent - SUB_BITS - 1) * SUB_BUCKETS + sub;
+    }
+
+    uint64_t Histogram::bucketUpper(int index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return static_cast<uint64_t>(index) + 1;
+        }
+        int exponent = (index - 2 * SUB_BUCKETS) / SUB_BUCKETS + SUB_BITS + 1;
+        uint64_t sub = static_cast<uint64_t>((index - 2 * SUB_BUCKETS) % SUB_BUCKETS);
+        return (SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS);
+    }
+
+    void Histogram::record(uint64_t ns) {
+        buckets_[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t current = max_.load(std::memory_order_relaxed);
+        while (ns > current && !max_.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    double Histogram::meanNs() const {
+        uint64_t n = count();
+        return n > 0 ? static_cast<double>(sum_ns_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    uint64_t Histogram::percentileNs(double q) const {
+        // Tổng của bucket có thể lệch count_ vài đơn vị khi đang ghi song song -> dùng tổng bucket
+        uint64_t total = 0;
+        for (const auto& bucket : buckets_) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * total));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(bucketUpper(i), maxNs());
+            }
+        }
+        return maxNs();
+    }
+
+    void setEnabled(bool enabled) {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    Histogram& histogram(Stage stage) {
+        return g_histograms[stage];
+    }
+
+    bool writeJson(const std::string& path) {
+        auto now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_start).count();
+
+        std::string json = "{\n";
+        json += "  \"timestamp_ms\": " + std::to_string(now_ms) + ",\n";
+        json += "  \"uptime_s\": " + cv::format("%.3f", uptime) + ",\n";
+        json += "  \"unit\": \"us\",\n";
+        json += "  \"stages\": {\n";
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const Histogram& h = g_histograms[i];
+            json += cv::format("    \"%s\": {\"count\": %llu, \"mean\": %.2f, \"p50\": %.2f, \"p95\": %.2f, \"p99\": %.2f, \"max\": %.2f}",
+                               STAGE_NAMES[i], static_cast<unsigned long long>(h.count()), to_us(h.meanNs()),
+                               to_us(h.percentileNs(0.50)), to_us(h.percentileNs(0.95)),
+                               to_us(h.percentileNs(0.99)), to_us(h.maxNs()));
+            json += (i + 1 < STAGE_COUNT) ? ",\n" : "\n";
+        }
+        json += "  }\n}\n";
+        return write_atomically(path, json);
+    }
+
+    bool writeCsv(const std::string& path) {
+        std::string csv = "stage,count,mean_us,p50_us,p95_us,p99_us,max_us\n";
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const Histogram& h = g_histograms[i];
+            csv += cv::format("%s,%llu,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+                              STAGE_NAMES[i], static_cast<unsigned long long>(h.count()), to_us(h.meanNs()),
+                              to_us(h.percentileNs(0.50)), to_us(h.percentileNs(0.95)),
+                              to_us(h.percentileNs(0.99)), to_us(h.maxNs()));
+        }
+        return write_atomically(path, csv);
+    }
+
+    void printReport() {
+        if (!enabled()) {
+            return;
+        }
+        std::cout << "[INFO] Độ trễ từng bước (ms):        count      mean       p50       p95       p99       max" << std::endl;
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            const Histogram& h = g_histograms[i];
+            if (h.count() == 0) {
+                continue;
+            }
+            std::cout << cv::format("  %-12s %22llu %9.3f %9.3f %9.3f %9.3f %9.3f", STAGE_NAMES[i],
+                                    static_cast<unsigned long long>(h.count()), h.meanNs() / 1e6,
+                                    h.percentileNs(0.50) / 1e6, h.percentileNs(0.95) / 1e6,
+                                    h.percentileNs(0.99) / 1e6, h.maxNs() / 1e6) << std::endl;
+        }
+    }
+
+    void Exporter::start(const std::string& base_path, double interval_seconds) {
+        stop();
+        base_path_ = base_path;
+        running_ = true;
+        if (interval_seconds <= 0.0) {
+            return;
+        }
+        auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(interval_seconds));
+        thread_ = std::thread([this, interval] {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (running_) {
+                if (cv_.wait_for(lock, interval, [this] { return !running_; })) {
+                    break;
+                }
+                lock.unlock();
+                writeSnapshot();
+                lock.lock();
+            }
+        });
+    }
+
+    void Exporter::stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                return;
+            }
+            running_ = false;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        writeSnapshot();
+        std::cout << "[INFO] Metrics đã ghi: " << base_path_ << ".json, " << base_path_ << ".csv" << std::endl;
+    }
+
+    void Exporter::writeSnapshot() {
+        if (!writeJson(base_path_ + ".json") || !writeCsv(base_path_ + ".csv")) {
+            std::cerr << "[WARNING] Không ghi được metrics vào " << base_path_ << ".json/.csv" << std::endl;
+        }
+    }
+}
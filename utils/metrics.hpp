@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Đo thời gian từng bước xử lý bằng histogram độ trễ (p50/p95/p99), xuất JSON/CSV
+ *
+ * Chi phí thấp để bật thường trực: mỗi lần đo = 2 lần đọc steady_clock + 3 atomic fetch_add
+ * (bucket, count, tổng ns) + vòng CAS cập nhật max (chỉ lặp khi giá trị mới lớn hơn max), đều
+ * relaxed, không lock, không cấp phát. Histogram dùng chung cho cả process (mọi session /
+ * thread cộng vào cùng 1 bảng).
+ */
+namespace Metrics {
+
+    /**
+     * @brief Các điểm đo (thứ tự cũng là thứ tự in / xuất file)
+     */
+    enum Stage {
+        DECODE = 0,     // Chờ nguồn trả frame
+        PREPROCESS,     // Letterbox frame vào tensor input
+        FORWARD,        // InferenceBackend::forward (1 lần gọi, có thể là cả batch)
+        PARSE,          // Đọc output YOLO -> box + score
+        NMS,            // cv::dnn::NMSBoxes
+        TRACKING,       // Tracker::try_get_main_ball
+        LOCAL_SEARCH,   // Template matching quanh điểm dự đoán (frame bỏ inference)
+        KALMAN,         // Kalman update / predict
+        BOUNCE,         // Phát hiện nảy + kiểm tra line In/Out
+        DRAW,           // annotate_frame
+        ENCODE,         // cv::VideoWriter::write trên thread encode
+        STAGE_COUNT
+    };
+
+    const char* stageName(Stage stage);
+
+    /**
+     * @brief Histogram log-linear: 8 bucket cho mỗi lũy thừa của 2 (sai số <= 12.5%), 1ns -> ~18 phút
+     */
+    class Histogram {
+    public:
+        static constexpr int SUB_BITS = 3;
+        static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+        static constexpr int MAX_EXPONENT = 40;
+        static constexpr int BUCKET_COUNT = 2 * SUB_BUCKETS + (MAX_EXPONENT - SUB_BITS) * SUB_BUCKETS;
+
+        void record(uint64_t ns);
+
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        double meanNs() const;
+        uint64_t maxNs() const { return max_.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Giá trị tại phân vị q (0..1), cận trên của bucket chứa nó (không vượt max)
+         */
+        uint64_t percentileNs(double q) const;
+
+    private:
+        static int bucketIndex(uint64_t ns);
+        static uint64_t bucketUpper(int index);
+
+        std::atomic<uint64_t> buckets_[BUCKET_COUNT] = {};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_ns_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    /**
+     * @brief Bật / tắt đo (tắt: ScopedTimer không đọc clock)
+     */
+    void setEnabled(bool enabled);
+    bool enabled();
+
+    Histogram& histogram(Stage stage);
+
+    inline void record(Stage stage, std::chrono::steady_clock::duration elapsed) {
+        if (enabled()) {
+            histogram(stage).record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    /**
+     * @brief Đo thời gian từ lúc tạo tới khi ra khỏi scope
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Stage stage) : stage_(stage), active_(enabled()) {
+            if (active_) {
+                start_ = std::chrono::steady_clock::now();
+            }
+        }
+        ~ScopedTimer() {
+            if (active_) {
+                histogram(stage_).record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count()));
+            }
+        }
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Stage stage_;
+        bool active_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    /**
+     * @brief Ghi snapshot mọi histogram (ghi file tạm rồi đổi tên -> không đọc được file dở dang)
+     */
+    bool writeJson(const std::string& path);
+    bool writeCsv(const std::string& path);
+
+    /**
+     * @brief In bảng p50/p95/p99 ra console
+     */
+    void printReport();
+
+    /**
+     * @brief Ghi <base>.json và <base>.csv mỗi interval giây trên thread riêng và 1 lần khi stop()
+     */
+    class Exporter {
+    public:
+        Exporter() = default;
+        ~Exporter() { stop(); }
+
+        /**
+         * @param base_path Đường dẫn không có đuôi (ví dụ "metrics" -> metrics.json, metrics.csv)
+         * @param interval_seconds <= 0: chỉ ghi khi stop()
+         */
+        void start(const std::string& base_path, double interval_seconds);
+
+        /**
+         * @brief Dừng thread và ghi snapshot cuối cùng
+         */
+        void stop();
+
+    private:
+        void writeSnapshot();
+
+        std::string base_path_;
+        std::thread thread_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool running_ = false;
+    };
+}
@@ -0,0 +1,47 @@
+#include "opencv_source.hpp"
+#include <iostream>
+
+bool OpenCVFrameSource::open(const std::string& path) {
+    release();
+    if (!cap_.open(path, cv::CAP_FFMPEG) && !cap_.open(path, cv::CAP_ANY)) {
+        std::cerr << "[ERROR] cv::VideoCapture không mở được: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool OpenCVFrameSource::isOpened() const {
+    return cap_.isOpened();
+}
+
+bool OpenCVFrameSource::read(cv::Mat& frame) {
+    if (!cap_.read(frame) || frame.empty()) {
+        return false;
+    }
+    scaleToOutput(frame);
+    return true;
+}
+
+double OpenCVFrameSource::get(int prop) const {
+    if (!cap_.isOpened()) {
+        return -1.0;
+    }
+    if (!output_size_.empty() && (prop == cv::CAP_PROP_FRAME_WIDTH || prop == cv::CAP_PROP_FRAME_HEIGHT)) {
+        cv::Size size = outputFrameSize(cv::Size(static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH)),
+                                                 static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT))));
+        return prop == cv::CAP_PROP_FRAME_WIDTH ? size.width : size.height;
+    }
+    return cap_.get(prop);
+}
+
+cv::Size OpenCVFrameSource::nativeFrameSize() const {
+    return cv::Size(static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_WIDTH)), static_cast<int>(cap_.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+bool OpenCVFrameSource::set(int prop, double value) {
+    return cap_.isOpened() && cap_.set(prop, value);
+}
+
+void OpenCVFrameSource::release() {
+    cap_.release();
+}
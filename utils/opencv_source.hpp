@@ -0,0 +1,22 @@
+#pragma once
+
+#include "frame_source.hpp"
+
+/**
+ * @brief Nguồn frame dùng cv::VideoCapture (thường là FFmpeg)
+ * Dùng khi không có libVLC, hoặc để so sánh tốc độ decode với VLC trên cùng 1 file.
+ */
+class OpenCVFrameSource : public FrameSource {
+public:
+    bool open(const std::string& path) override;
+    bool isOpened() const override;
+    bool read(cv::Mat& frame) override;
+    double get(int prop) const override;
+    cv::Size nativeFrameSize() const override;
+    bool set(int prop, double value) override;
+    void release() override;
+    std::string name() const override { return "opencv"; }
+
+private:
+    cv::VideoCapture cap_;
+};
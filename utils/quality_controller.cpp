@@ -0,0 +1,135 @@
+#include "quality_controller.hpp"
+#include "../config.hpp"
+#include <iostream>
+#include <algorithm>
+
+namespace {
+    // Ngưỡng so với ngân sách: chậm hơn 5% -> hạ mức; nhanh hơn 40% -> nâng mức
+    // (khoảng cách lớn để không dao động qua lại giữa 2 mức)
+    const double DEGRADE_RATIO = 1.05;
+    const double UPGRADE_RATIO = 0.6;
+
+    // Thứ tự hạ mức: overlay rẻ nhất để bỏ, sau đó giảm input size, cuối cùng bỏ bớt frame inference
+    const QualityController::Level LADDER[] = {
+        { Config::MODEL_INPUT_SIZE, 1, true },
+        { Config::MODEL_INPUT_SIZE, 1, false },
+        { 512, 1, false },
+        { 416, 1, false },
+        { 416, 2, false },
+        { 320, 2, false },
+        { 320, 3, false },
+    };
+}
+
+QualityController::QualityController(double target_fps, int window_frames)
+    : target_fps_(target_fps)
+    , budget_ms_(target_fps > 0.0 ? 1000.0 / target_fps : 0.0)
+    , window_frames_(std::max(1, window_frames))
+{
+    for (const Level& level : LADDER) {
+        // Model input nhỏ hơn mặc định trong config -> bỏ các mức lớn hơn input đó
+        if (level.input_size <= Config::MODEL_INPUT_SIZE) {
+            levels_.push_back(level);
+        }
+    }
+    frames_per_level_.assign(levels_.size(), 0);
+}
+
+void QualityController::probeInputSizes(DetectorSession& session) {
+    if (!enabled()) {
+        return;
+    }
+    std::vector<int> rejected;
+    for (const Level& level : levels_) {
+        int size = level.input_size;
+        if (size == Config::MODEL_INPUT_SIZE || std::find(rejected.begin(), rejected.end(), size) != rejected.end()) {
+            continue;
+        }
+        int sizes[] = { 1, 3, size, size };
+        cv::Mat blob(4, sizes, CV_32F, cv::Scalar(0));
+        try {
+            session.run_inference(blob);
+        } catch (const cv::Exception& e) {
+            rejected.push_back(size);
+            std::cerr << "[WARNING] Quality: model không chạy được input " << size << "x" << size
+                      << " (input cố định khi export?), bỏ mức này" << std::endl;
+        }
+    }
+    levels_.erase(std::remove_if(levels_.begin(), levels_.end(), [&](const Level& level) {
+        return std::find(rejected.begin(), rejected.end(), level.input_size) != rejected.end();
+    }), levels_.end());
+    frames_per_level_.assign(levels_.size(), 0);
+
+    // Đưa Net về shape mặc định để frame đầu tiên không phải cấp phát lại
+    int sizes[] = { 1, 3, Config::MODEL_INPUT_SIZE, Config::MODEL_INPUT_SIZE };
+    session.run_inference(cv::Mat(4, sizes, CV_32F, cv::Scalar(0)));
+}
+
+ProcessingQuality QualityController::qualityFor(int frame_idx) const {
+    ProcessingQuality quality;
+    if (!enabled()) {
+        return quality;
+    }
+    const Level& level = levels_[level_.load()];
+    quality.input_size = level.input_size;
+    quality.run_inference = (frame_idx % level.inference_stride) == 0;
+    quality.detailed_overlay = level.detailed_overlay;
+    return quality;
+}
+
+void QualityController::record(int frame_idx, double busy_ms) {
+    if (!enabled()) {
+        return;
+    }
+    frames_per_level_[level_.load()]++;
+    if (cooldown_ > 0) {
+        cooldown_--;
+        return;
+    }
+    window_sum_ms_ += busy_ms;
+    window_count_++;
+    if (window_count_ < window_frames_) {
+        return;
+    }
+
+    double avg_ms = window_sum_ms_ / window_count_;
+    window_sum_ms_ = 0.0;
+    window_count_ = 0;
+
+    int level = level_.load();
+    if (avg_ms > budget_ms_ * DEGRADE_RATIO && level + 1 < static_cast<int>(levels_.size())) {
+        changeLevel(frame_idx, level + 1, avg_ms);
+    } else if (avg_ms < budget_ms_ * UPGRADE_RATIO && level > 0) {
+        changeLevel(frame_idx, level - 1, avg_ms);
+    }
+}
+
+void QualityController::changeLevel(int frame_idx, int new_level, double avg_ms) {
+    int old_level = level_.exchange(new_level);
+    changes_++;
+    // Frame đang nằm trong pipeline vẫn chạy mức cũ -> bỏ qua 1 cửa sổ trước khi đo lại
+    cooldown_ = window_frames_;
+    std::cout << std::endl << "[INFO] Quality: frame " << frame_idx << " " << (new_level > old_level ? "hạ" : "nâng")
+              << " mức " << old_level << " -> " << new_level
+              << " (TB " << cv::format("%.1f", avg_ms) << "ms / ngân sách " << cv::format("%.1f", budget_ms_) << "ms): "
+              << describe(levels_[new_level]) << std::endl;
+}
+
+std::string QualityController::describe(const Level& level) {
+    return "input " + std::to_string(level.input_size)
+         + ", inference 1/" + std::to_string(level.inference_stride)
+         + ", overlay " + (level.detailed_overlay ? "đầy đủ" : "cơ bản");
+}
+
+void QualityController::printReport() const {
+    if (!enabled()) {
+        return;
+    }
+    std::cout << "[INFO] Quality (target " << cv::format("%.1f", target_fps_) << " fps): " << changes_
+              << " lần đổi mức, mức cuối " << level_.load() << std::endl;
+    for (size_t i = 0; i < levels_.size(); i++) {
+        if (frames_per_level_[i] > 0) {
+            std::cout << "  - mức " << i << " (" << describe(levels_[i]) << "): " << frames_per_level_[i] << " frame" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "../detectors/ball_detector.hpp"
+
+/**
+ * @brief Điều chỉnh chất lượng xử lý để giữ tốc độ ~ target fps (máy yếu / camera live)
+ *
+ * Đo thời gian xử lý mỗi frame (không tính thời gian chờ nguồn), trung bình theo cửa sổ
+ * N frame rồi so với ngân sách 1000 / target_fps:
+ *   - chậm hơn ngân sách -> hạ 1 mức (tắt overlay chi tiết, giảm input size, bỏ bớt frame
+ *     inference và dùng Kalman dự đoán cho frame bị bỏ)
+ *   - dư nhiều so với ngân sách -> nâng 1 mức
+ * Mỗi lần đổi mức được log (frame, latency, mức mới) để đối chiếu chất lượng với tải.
+ *
+ * record() chỉ được gọi từ 1 thread; qualityFor() gọi được từ thread khác (pipeline).
+ */
+class QualityController {
+public:
+    struct Level {
+        int input_size;
+        int inference_stride;   // Chạy inference 1 trên N frame
+        bool detailed_overlay;
+    };
+
+    /**
+     * @param target_fps Tốc độ cần giữ (<= 0: tắt, luôn ở chất lượng cao nhất)
+     * @param window_frames Số frame trung bình trước mỗi quyết định
+     */
+    explicit QualityController(double target_fps, int window_frames = 30);
+
+    bool enabled() const { return target_fps_ > 0.0; }
+
+    /**
+     * @brief Bỏ các mức có input size model không chạy được (model export với input cố định)
+     * Forward thử 1 blob rỗng ở mỗi size, đồng thời làm nóng Net cho các shape đó.
+     */
+    void probeInputSizes(DetectorSession& session);
+
+    /**
+     * @brief Chất lượng áp dụng cho frame frame_idx theo mức hiện tại
+     */
+    ProcessingQuality qualityFor(int frame_idx) const;
+
+    /**
+     * @brief Ghi nhận thời gian xử lý 1 frame, có thể đổi mức
+     * @param busy_ms Thời gian xử lý (không tính chờ nguồn); với pipeline là stage chậm nhất
+     */
+    void record(int frame_idx, double busy_ms);
+
+    /**
+     * @brief In số frame ở mỗi mức và số lần đổi mức
+     */
+    void printReport() const;
+
+private:
+    void changeLevel(int frame_idx, int new_level, double avg_ms);
+    static std::string describe(const Level& level);
+
+    double target_fps_;
+    double budget_ms_;
+    int window_frames_;
+    std::vector<Level> levels_;
+    std::atomic<int> level_{0};
+    std::vector<int> frames_per_level_;
+    double window_sum_ms_ = 0.0;
+    int window_count_ = 0;
+    int cooldown_ = 0;          // Số frame còn lại trước khi được đổi mức tiếp (chờ tác dụng của lần đổi trước)
+    int changes_ = 0;
+};
@@ -0,0 +1,227 @@
+#include "segment_runner.hpp"
+#include "metrics.hpp"
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Detection của cùng 1 frame từ 2 decoder khác nhau (sau NMS, cùng thứ tự)
+    bool same_detections(const BallDetections& a, const BallDetections& b) {
+        if (a.boxes != b.boxes || a.confidences.size() != b.confidences.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.confidences.size(); i++) {
+            if (std::abs(a.confidences[i] - b.confidences[i]) > 1e-4f) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+SegmentRunner::SegmentRunner(int segments, int overlap_frames, int batch_size)
+    : segments_(std::max(1, segments))
+    , overlap_frames_(std::max(0, overlap_frames))
+    , batch_size_(std::max(1, batch_size))
+{
+}
+
+void SegmentRunner::runSegment(Segment& segment, DetectorSession& session, FrameSource& source) {
+    auto start_time = std::chrono::steady_clock::now();
+    const int decode_start = std::max(0, segment.start - overlap_frames_);
+    session.set_input_order(source.channelOrder());
+    session.set_native_size(source.nativeFrameSize());
+
+    if (decode_start > 0 && !source.set(cv::CAP_PROP_POS_FRAMES, decode_start)) {
+        std::cerr << std::endl << "[ERROR] Đoạn bắt đầu tại frame " << segment.start
+                  << ": nguồn [" << source.name() << "] không seek được" << std::endl;
+        segment.failed = true;
+        return;
+    }
+
+    std::vector<cv::Mat> batch;
+    int first_idx = decode_start;
+    // Gửi batch đã gom qua forward, chia kết quả vào phần overlap / phần của đoạn
+    auto flush = [&]() {
+        std::vector<BallDetections> detections = session.detect_batch(batch);
+        for (size_t i = 0; i < detections.size(); i++) {
+            int idx = first_idx + static_cast<int>(i);
+            if (idx < segment.start) {
+                segment.overlap.push_back(std::move(detections[i]));
+            } else {
+                segment.detections.push_back(std::move(detections[i]));
+            }
+        }
+        first_idx += static_cast<int>(batch.size());
+        batch.clear();
+    };
+
+    FrameLease lease;
+    try {
+        for (int idx = decode_start; segment.end < 0 || idx < segment.end; idx++) {
+            auto read_start = std::chrono::steady_clock::now();
+            if (!source.readLease(lease)) {
+                break;
+            }
+            Metrics::record(Metrics::DECODE, std::chrono::steady_clock::now() - read_start);
+            if (lease.frameNumber() >= 0 && lease.frameNumber() != idx) {
+                segment.misaligned++;
+            }
+            // Batch 1: dùng thẳng buffer của lease; batch > 1: copy vì lease được trả ngay
+            batch.push_back(batch_size_ > 1 ? lease.mat().clone() : lease.mat());
+            if (static_cast<int>(batch.size()) >= batch_size_) {
+                flush();
+            }
+            lease.release();
+        }
+        if (!batch.empty()) {
+            flush();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << std::endl << "[ERROR] Đoạn bắt đầu tại frame " << segment.start << ": " << e.what() << std::endl;
+        segment.failed = true;
+    }
+    segment.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+bool SegmentRunner::run(const std::shared_ptr<const DetectorModel>& model, DetectorSession& session,
+                        const SourceFactory& open_source, int total_frames, const cv::Size& frame_size,
+                        std::vector<FrameResult>& results) {
+    results.clear();
+    plan_.clear();
+    missing_frames_ = 0;
+    if (total_frames <= 0) {
+        std::cerr << "[ERROR] Chia đoạn cần biết tổng số frame của video" << std::endl;
+        return false;
+    }
+
+    // Đoạn đều nhau; đoạn cuối đọc tới hết video (CAP_PROP_FRAME_COUNT có thể lệch vài frame)
+    int segments = std::min(segments_, total_frames);
+    for (int i = 0; i < segments; i++) {
+        Segment segment;
+        segment.start = static_cast<int>(static_cast<int64_t>(total_frames) * i / segments);
+        segment.end = (i + 1 < segments) ? static_cast<int>(static_cast<int64_t>(total_frames) * (i + 1) / segments) : -1;
+        plan_.push_back(std::move(segment));
+    }
+
+    // Mọi đoạn dùng chung thread pool của OpenCV -> chia đều core cho các đoạn, tránh oversubscription
+    const int saved_threads = cv::getNumThreads();
+    const int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    cv::setNumThreads(std::max(1, cores / segments));
+
+    // --- Bước 1: decode + inference song song ---
+    auto detect_start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<DetectorSession>> sessions;
+    std::vector<std::unique_ptr<FrameSource>> sources;
+    bool ok = true;
+    for (int i = 0; i < segments && ok; i++) {
+        std::unique_ptr<FrameSource> source = open_source();
+        if (!source) {
+            std::cerr << "[ERROR] Không mở được nguồn cho đoạn " << i << std::endl;
+            ok = false;
+            break;
+        }
+        sources.push_back(std::move(source));
+        // Đoạn 0 dùng session của caller, các đoạn khác tạo engine riêng từ model dùng chung
+        // (ONNX Runtime: chia core như thread pool của OpenCV ở trên)
+        sessions.push_back(i == 0 ? nullptr : std::make_unique<DetectorSession>(model, std::max(1, cores / segments)));
+    }
+    if (ok) {
+        std::vector<std::thread> workers;
+        for (int i = 0; i < segments; i++) {
+            workers.emplace_back([&, i] {
+                // Session của caller đã warm-up; engine mới warm-up song song trên thread của đoạn
+                if (i > 0) {
+                    sessions[i]->warm_up(Config::MODEL_WARMUP_RUNS, batch_size_);
+                }
+                runSegment(plan_[i], i == 0 ? session : *sessions[i], *sources[i]);
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+    for (auto& source : sources) {
+        source->release();
+    }
+    sessions.clear();
+    cv::setNumThreads(saved_threads);
+    detect_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - detect_start).count();
+    for (const Segment& segment : plan_) {
+        ok = ok && !segment.failed;
+    }
+    if (!ok) {
+        return false;
+    }
+
+    // --- Kiểm tra biên: overlap của đoạn i phải trùng detection cuối đoạn i-1 ---
+    for (int i = 1; i < segments; i++) {
+        Segment& segment = plan_[i];
+        const Segment& prev = plan_[i - 1];
+        int overlap_start = segment.start - static_cast<int>(segment.overlap.size());
+        for (size_t k = 0; k < segment.overlap.size(); k++) {
+            int prev_idx = overlap_start + static_cast<int>(k) - prev.start;
+            if (prev_idx >= 0 && prev_idx < static_cast<int>(prev.detections.size())
+                && !same_detections(segment.overlap[k], prev.detections[prev_idx])) {
+                segment.overlap_mismatches++;
+            }
+        }
+    }
+
+    // --- Bước 2: tracking tuần tự qua mọi đoạn (state đi liên tục qua biên) ---
+    auto stitch_start = std::chrono::steady_clock::now();
+    session.reset();
+    const BallDetections no_detections;
+    int frame_idx = 0;
+    for (int i = 0; i < segments; i++) {
+        const Segment& segment = plan_[i];
+        // Đoạn trước kết thúc sớm (video ngắn hơn FRAME_COUNT / lỗi đọc) -> frame thiếu coi như không có bóng
+        int gap = (i > 0 && !segment.detections.empty()) ? segment.start - frame_idx : 0;
+        for (int k = 0; k < gap; k++) {
+            results.push_back(session.track_ball(no_detections, frame_size, frame_idx++));
+        }
+        missing_frames_ += std::max(0, gap);
+        for (const BallDetections& detections : segment.detections) {
+            results.push_back(session.track_ball(detections, frame_size, frame_idx++));
+        }
+    }
+    stitch_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - stitch_start).count();
+    return true;
+}
+
+void SegmentRunner::printReport() const {
+    size_t frames = 0;
+    for (const Segment& segment : plan_) {
+        frames += segment.detections.size();
+    }
+    std::cout << "[INFO] Chia đoạn (" << plan_.size() << " đoạn, overlap " << overlap_frames_ << " frame, batch "
+              << batch_size_ << "): detect " << cv::format("%.2f", detect_seconds_) << "s";
+    if (detect_seconds_ > 0.0) {
+        std::cout << " (" << cv::format("%.1f", frames / detect_seconds_) << " fps)";
+    }
+    std::cout << ", nối tracking " << cv::format("%.3f", stitch_seconds_) << "s" << std::endl;
+
+    for (size_t i = 0; i < plan_.size(); i++) {
+        const Segment& segment = plan_[i];
+        std::cout << "  - đoạn " << i << " [" << segment.start << ", "
+                  << segment.start + static_cast<int>(segment.detections.size()) << "): "
+                  << cv::format("%.2f", segment.seconds) << "s";
+        if (segment.seconds > 0.0) {
+            std::cout << " (" << cv::format("%.1f", segment.detections.size() / segment.seconds) << " fps)";
+        }
+        if (i > 0) {
+            std::cout << ", overlap khác đoạn trước: " << segment.overlap_mismatches << "/" << segment.overlap.size();
+        }
+        std::cout << std::endl;
+        if (segment.misaligned > 0 || segment.overlap_mismatches > 0) {
+            std::cerr << "[WARNING] Đoạn " << i << ": " << segment.misaligned << " frame lệch vị trí sau seek, "
+                      << segment.overlap_mismatches << " frame overlap khác đoạn trước"
+                      << " -> kết quả có thể khác chạy tuần tự (nguồn seek không chính xác?)" << std::endl;
+        }
+    }
+    if (missing_frames_ > 0) {
+        std::cerr << "[WARNING] " << missing_frames_ << " frame không đọc được giữa các đoạn (coi như không có bóng)" << std::endl;
+    }
+}
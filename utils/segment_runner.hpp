@@ -0,0 +1,78 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "frame_source.hpp"
+#include "../detectors/ball_detector.hpp"
+
+/**
+ * @brief Xử lý 1 video dài bằng nhiều đoạn thời gian song song
+ *
+ *   Bước 1 (song song): chia [0, total_frames) thành N đoạn, mỗi đoạn 1 thread với nguồn và
+ *   DetectorSession riêng: seek -> decode -> preprocess -> forward -> decode_detections.
+ *   Detection không có state nên kết quả mỗi frame giống hệt chạy tuần tự.
+ *   Mỗi đoạn decode thêm overlap frame trước điểm bắt đầu; detection của phần overlap được
+ *   so với đoạn trước để phát hiện seek không chính xác.
+ *
+ *   Bước 2 (tuần tự, rất nhanh): chạy track_ball lần lượt trên detection đã lưu, state
+ *   tracking (Tracker, Kalman, bounce) đi liên tục qua biên đoạn -> khớp chính xác với chạy
+ *   tuần tự. Tracking chỉ tốn vài micro giây mỗi frame so với hàng chục ms của forward.
+ */
+class SegmentRunner {
+public:
+    /**
+     * @brief Tạo và mở 1 nguồn mới cho 1 đoạn (nullptr nếu lỗi)
+     */
+    using SourceFactory = std::function<std::unique_ptr<FrameSource>()>;
+
+    /**
+     * @param segments Số đoạn (= số thread decode + inference)
+     * @param overlap_frames Số frame decode thêm trước mỗi đoạn (trừ đoạn đầu)
+     * @param batch_size Số frame mỗi lần forward trong mỗi đoạn
+     */
+    SegmentRunner(int segments, int overlap_frames, int batch_size = 1);
+
+    /**
+     * @brief Chạy cả 2 bước
+     * @param model Model dùng chung để tạo session cho đoạn 1..N-1
+     * @param session Session chạy inference đoạn 0 và toàn bộ tracking (đã configure_court)
+     * @param open_source Mở nguồn mới cho mỗi đoạn (phải hỗ trợ seek CAP_PROP_POS_FRAMES)
+     * @param total_frames Số frame của video (CAP_PROP_FRAME_COUNT)
+     * @param frame_size Kích thước frame nguồn trả ra
+     * @param results Kết quả tracking của từng frame, theo thứ tự
+     * @return false nếu 1 đoạn bị lỗi
+     */
+    bool run(const std::shared_ptr<const DetectorModel>& model, DetectorSession& session,
+             const SourceFactory& open_source, int total_frames, const cv::Size& frame_size,
+             std::vector<FrameResult>& results);
+
+    /**
+     * @brief In thời gian từng bước, số frame mỗi đoạn và kết quả kiểm tra biên đoạn
+     */
+    void printReport() const;
+
+private:
+    struct Segment {
+        int start = 0;                          // Frame đầu tiên thuộc đoạn
+        int end = 0;                            // Frame sau frame cuối cùng (-1: đọc tới hết video)
+        std::vector<BallDetections> detections; // Detection của [start, start + detections.size())
+        std::vector<BallDetections> overlap;    // Detection của [start - overlap.size(), start)
+        int overlap_mismatches = 0;             // Số frame overlap có detection khác đoạn trước
+        int misaligned = 0;                     // Số frame có số thứ tự khác vị trí mong đợi
+        double seconds = 0.0;
+        bool failed = false;
+    };
+
+    void runSegment(Segment& segment, DetectorSession& session, FrameSource& source);
+
+    int segments_;
+    int overlap_frames_;
+    int batch_size_;
+    std::vector<Segment> plan_;
+    int missing_frames_ = 0;
+    double detect_seconds_ = 0.0;
+    double stitch_seconds_ = 0.0;
+};
@@ -0,0 +1,141 @@
+#include "synthetic_source.hpp"
+#include "../config.hpp"
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+bool SyntheticFrameSource::open(const std::string& spec) {
+    release();
+    
+    int width = Config::SYNTHETIC_WIDTH;
+    int height = Config::SYNTHETIC_HEIGHT;
+    double fps = Config::SYNTHETIC_FPS;
+    int frames = Config::SYNTHETIC_FRAMES;
+    
+    if (!spec.empty() && spec != "default") {
+        if (std::sscanf(spec.c_str(), "%dx%d@%lf:%d", &width, &height, &fps, &frames) != 4) {
+            std::cerr << "[ERROR] Spec nguồn giả lập không hợp lệ: " << spec
+                      << " (đúng dạng: WxH@FPS:FRAMES)" << std::endl;
+            return false;
+        }
+    }
+    if (width <= 0 || height <= 0 || fps <= 0 || frames <= 0) {
+        std::cerr << "[ERROR] Thông số nguồn giả lập không hợp lệ" << std::endl;
+        return false;
+    }
+    
+    // Có output size: vẽ thẳng ở kích thước gốc thu nhỏ vào khung đó (tương đương decoder scale sẵn)
+    native_size_ = cv::Size(width, height);
+    size_ = outputFrameSize(native_size_);
+    fps_ = fps;
+    total_frames_ = frames;
+    renderCourt();
+    opened_ = true;
+    return true;
+}
+
+void SyntheticFrameSource::renderCourt() {
+    const int w = size_.width;
+    const int h = size_.height;
+    court_ = cv::Mat(h, w, CV_8UC3, cv::Scalar(70, 120, 60));  // Nền xanh lá (BGR)
+    
+    // Mặt sân xanh dương
+    cv::Rect court_area(w / 8, h / 6, w * 3 / 4, h * 2 / 3);
+    cv::rectangle(court_, court_area, cv::Scalar(140, 90, 40), cv::FILLED);
+    
+    // Đường biên: 2 đường ngang + 2 đường dọc nghiêng ~82 độ (giống góc camera thật,
+    // LineDetector lọc line trong khoảng 80-85 độ)
+    int thickness = std::max(3, h / 180);
+    double slant = std::tan((90.0 - 82.0) * CV_PI / 180.0) * court_area.height;
+    cv::Scalar white(255, 255, 255);
+    cv::line(court_, court_area.tl(), cv::Point(court_area.br().x, court_area.y), white, thickness);
+    cv::line(court_, cv::Point(court_area.x, court_area.br().y), court_area.br(), white, thickness);
+    cv::line(court_, court_area.tl(), cv::Point(court_area.x + (int)slant, court_area.br().y), white, thickness);
+    cv::line(court_, cv::Point(court_area.br().x, court_area.y),
+             cv::Point(court_area.br().x + (int)slant, court_area.br().y), white, thickness);
+    
+    // Lưới ở giữa sân
+    cv::line(court_, cv::Point(w / 2, court_area.y - h / 20), cv::Point(w / 2, court_area.br().y + h / 20),
+             cv::Scalar(220, 220, 220), std::max(1, thickness / 2));
+}
+
+cv::Point2f SyntheticFrameSource::ballPosition(int frame_number) const {
+    const double w = size_.width;
+    const double h = size_.height;
+    double t = frame_number / fps_;
+    
+    // Bóng bay qua lại giữa 2 đầu sân (chu kỳ 2 giây / lượt), nảy 2 lần mỗi lượt
+    const double rally_period = 2.0;
+    double phase = std::fmod(t, 2.0 * rally_period) / rally_period;  // [0, 2)
+    double along = phase < 1.0 ? phase : 2.0 - phase;                // [0, 1] đi rồi về
+    double x = w * (0.2 + 0.6 * along);
+    
+    double ground_y = h * 0.72;
+    double bounce_height = h * 0.35;
+    double bounce_phase = std::fmod(t, rally_period / 2.0) / (rally_period / 2.0);
+    double y = ground_y - bounce_height * std::sin(CV_PI * bounce_phase);
+    
+    return cv::Point2f(static_cast<float>(x), static_cast<float>(y));
+}
+
+bool SyntheticFrameSource::isOpened() const {
+    return opened_;
+}
+
+bool SyntheticFrameSource::read(cv::Mat& frame) {
+    if (!opened_ || position_ >= total_frames_) {
+        return false;
+    }
+    
+    court_.copyTo(frame);
+    cv::Point2f ball = ballPosition(position_);
+    int radius = std::max(4, size_.height / 90);
+    cv::circle(frame, ball, radius, cv::Scalar(40, 230, 240), cv::FILLED, cv::LINE_AA);  // Bóng vàng
+    
+    position_++;
+    return true;
+}
+
+double SyntheticFrameSource::get(int prop) const {
+    if (!opened_) {
+        return -1.0;
+    }
+    switch (prop) {
+        case cv::CAP_PROP_FRAME_WIDTH:
+            return size_.width;
+        case cv::CAP_PROP_FRAME_HEIGHT:
+            return size_.height;
+        case cv::CAP_PROP_FPS:
+            return fps_;
+        case cv::CAP_PROP_FRAME_COUNT:
+            return total_frames_;
+        case cv::CAP_PROP_POS_FRAMES:
+            return position_;
+        case cv::CAP_PROP_POS_MSEC:
+            return position_ * 1000.0 / fps_;
+        default:
+            return -1.0;
+    }
+}
+
+bool SyntheticFrameSource::set(int prop, double value) {
+    if (!opened_) {
+        return false;
+    }
+    switch (prop) {
+        case cv::CAP_PROP_POS_FRAMES:
+            position_ = std::clamp(static_cast<int>(value), 0, total_frames_);
+            return true;
+        case cv::CAP_PROP_POS_MSEC:
+            return set(cv::CAP_PROP_POS_FRAMES, value / 1000.0 * fps_);
+        default:
+            return false;
+    }
+}
+
+void SyntheticFrameSource::release() {
+    opened_ = false;
+    position_ = 0;
+    court_.release();
+}
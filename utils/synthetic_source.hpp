@@ -0,0 +1,39 @@
+#pragma once
+
+#include "frame_source.hpp"
+
+/**
+ * @brief Nguồn frame giả lập: sân pickleball + bóng nảy, hoàn toàn xác định (deterministic)
+ * 
+ * Không cần file video hay libVLC -> dùng để benchmark pipeline và chạy thử trên máy bất kỳ.
+ * Spec truyền vào open(): "WxH@FPS:FRAMES" (ví dụ "1920x1080@30:900"),
+ * chuỗi rỗng hoặc "default" dùng giá trị trong config.hpp.
+ */
+class SyntheticFrameSource : public FrameSource {
+public:
+    bool open(const std::string& spec) override;
+    bool isOpened() const override;
+    bool read(cv::Mat& frame) override;
+    double get(int prop) const override;
+    cv::Size nativeFrameSize() const override { return native_size_; }
+    bool set(int prop, double value) override;
+    void release() override;
+    std::string name() const override { return "synthetic"; }
+    
+    /**
+     * @brief Vị trí thật (ground truth) của tâm bóng tại frame_number
+     * (theo tọa độ frame trả ra, tức là sau setOutputSize nếu có)
+     */
+    cv::Point2f ballPosition(int frame_number) const;
+
+private:
+    void renderCourt();
+    
+    cv::Size size_;
+    cv::Size native_size_;  // Kích thước trong spec, trước khi thu nhỏ vào output size
+    double fps_ = 30.0;
+    int total_frames_ = 0;
+    int position_ = 0;
+    bool opened_ = false;
+    cv::Mat court_;  // Nền sân vẽ sẵn 1 lần, mỗi frame chỉ copy + vẽ bóng
+};
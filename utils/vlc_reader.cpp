@@ -1,8 +1,12 @@
 #include "vlc_reader.hpp"
+#include "../config.hpp"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <cstring>
+#include <algorithm>
+#include <cstdlib>
+#include <map>
 
 VLCVideoReader::VLCVideoReader() 
     : vlc_instance_(nullptr)
@@ -13,8 +17,23 @@ VLCVideoReader::VLCVideoReader()
     , frame_height_(0)
     , fps_(0.0)
     , total_frames_(0)
+    , parse_done_(false)
+    , format_known_(false)
+    , first_frame_ms_(-1.0)
     , frame_ready_(false)
     , format_setup_(false)
+    , mode_(DecodeMode::Ring)
+    , drop_policy_(DropPolicy::DropOldest)
+    , ring_capacity_(8)
+    , ring_(std::make_shared<RingState>())
+    , decoded_frames_(0)
+    , dropped_frames_(0)
+    , late_frames_(0)
+    , is_stream_(false)
+    , use_index_(true)
+    , position_(0)
+    , layout_(PixelLayout::BGR)
+    , vlc_layout_(PixelLayout::RGB)
 {
 }
 
@@ -22,18 +41,133 @@ VLCVideoReader::~VLCVideoReader() {
     release();
 }
 
+libvlc_instance_t* VLCVideoReader::shared_instance() {
+    // Khởi tạo 1 lần, thread-safe (C++11 static local). Không bao giờ giải phóng: sống hết process.
+    // Không bỏ frame trễ / không skip decode: ở chế độ Offline lock() chặn khi ring đầy nên mọi
+    // frame đều "trễ" so với đồng hồ phát nhưng vẫn phải được giao đủ; ở chế độ Ring ring không
+    // bao giờ chặn nên các option này gần như không ảnh hưởng. Pipeline không dùng audio.
+    static libvlc_instance_t* instance = [] {
+        const char* const args[] = { "--no-drop-late-frames", "--no-skip-frames", "--no-audio" };
+        return libvlc_new(3, args);
+    }();
+    return instance;
+}
+
+namespace {
+    std::mutex media_cache_mutex;
+    std::map<std::string, std::shared_ptr<const VLCVideoReader::MediaInfo>> media_cache;
+    
+    // Frame index theo file: build 1 lần, các reader seek cùng lúc (chia đoạn) chờ chung
+    struct IndexEntry {
+        std::once_flag once;
+        std::atomic<bool> ready{false};
+        std::shared_ptr<const FrameIndex> index;
+    };
+    std::map<std::string, std::shared_ptr<IndexEntry>> index_cache;
+}
+
+std::shared_ptr<const VLCVideoReader::MediaInfo> VLCVideoReader::media_cache_lookup(const std::string& path) {
+    std::lock_guard<std::mutex> lock(media_cache_mutex);
+    auto it = media_cache.find(path);
+    return it != media_cache.end() ? it->second : nullptr;
+}
+
+void VLCVideoReader::media_cache_store(const std::string& path, const MediaInfo& info) {
+    std::lock_guard<std::mutex> lock(media_cache_mutex);
+    media_cache[path] = std::make_shared<const MediaInfo>(info);
+}
+
+std::shared_ptr<const FrameIndex> VLCVideoReader::shared_frame_index(const std::string& path, bool build) {
+    std::shared_ptr<IndexEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(media_cache_mutex);
+        std::shared_ptr<IndexEntry>& slot = index_cache[path];
+        if (!slot) {
+            slot = std::make_shared<IndexEntry>();
+        }
+        entry = slot;
+    }
+    if (!build) {
+        return entry->ready ? entry->index : nullptr;
+    }
+    std::call_once(entry->once, [&] {
+        auto index = std::make_shared<FrameIndex>();
+        if (index->loadOrBuild(path)) {
+            entry->index = index;
+        }
+        entry->ready = true;
+    });
+    return entry->index;
+}
+
+bool VLCVideoReader::ensureIndex() {
+    if (hasIndex()) {
+        return true;
+    }
+    if (!use_index_ || is_stream_ || video_path_.empty()) {
+        return false;
+    }
+    std::shared_ptr<const FrameIndex> index = shared_frame_index(video_path_, true);
+    if (!index || index->empty()) {
+        return false;
+    }
+    // Callback của VLC (onParsed, DurationChanged) đọc index_ trong metadata_mutex_
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    index_ = index;
+    total_frames_ = index_->frameCount();
+    if (index_->frameDurationMs() > 0.0) {
+        fps_ = 1000.0 / index_->frameDurationMs();
+    }
+    return true;
+}
+
+libvlc_media_t* VLCVideoReader::createMedia(double start_seconds) const {
+    libvlc_media_t* media = is_stream_ ? libvlc_media_new_location(vlc_instance_, video_path_.c_str())
+                                       : libvlc_media_new_path(vlc_instance_, video_path_.c_str());
+    if (!media) {
+        return nullptr;
+    }
+    if (mode_ == DecodeMode::Offline) {
+        libvlc_media_add_option(media, ":no-audio");
+    }
+    if (is_stream_) {
+        // Buffer mạng nhỏ = độ trễ thấp, nhưng dễ giật hơn khi mạng không ổn định
+        libvlc_media_add_option(media, cv::format(":network-caching=%d", Config::VLC_NETWORK_CACHING_MS).c_str());
+        libvlc_media_add_option(media, ":no-audio");
+    }
+    if (start_seconds > 0.0) {
+        libvlc_media_add_option(media, cv::format(":start-time=%.6f", start_seconds).c_str());
+    }
+    return media;
+}
+
 bool VLCVideoReader::open(const std::string& video_path) {
     release(); // Đóng video cũ nếu có
+    open_time_ = std::chrono::steady_clock::now();
+    
+    video_path_ = video_path;
+    is_stream_ = isStreamUrl(video_path);
     
-    // Khởi tạo VLC instance
-    vlc_instance_ = libvlc_new(0, nullptr);
+    // Metadata đã có trong cache của process (mở lại cùng file) -> không parse lại.
+    // Stream live không có metadata cố định và không có file để index.
+    std::shared_ptr<const MediaInfo> cached = is_stream_ ? nullptr : media_cache_lookup(video_path);
+    
+    // Frame index: chỉ lấy nếu process đã load / build sẵn. Lần đầu để tới lần seek đầu tiên
+    // (ensureIndex), open() không chờ demux cả file. Gán trước khi tạo media (callback parse đọc index_)
+    if (!is_stream_ && use_index_) {
+        index_ = shared_frame_index(video_path, false);
+    }
+    
+    // VLC instance dùng chung cho cả process (load plugin 1 lần)
+    vlc_instance_ = shared_instance();
     if (!vlc_instance_) {
         std::cerr << "[ERROR] Không thể khởi tạo VLC instance" << std::endl;
         return false;
     }
+    libvlc_retain(vlc_instance_);
     
-    // Tạo media từ file path
-    media_ = libvlc_media_new_path(vlc_instance_, video_path.c_str());
+    // Tạo media từ file path / URL (rẻ; media không được cache vì mỗi reader gắn option riêng như :start-time)
+    media_ = createMedia(0.0);
     if (!media_) {
         std::cerr << "[ERROR] Không thể tạo VLC media từ: " << video_path << std::endl;
         libvlc_release(vlc_instance_);
@@ -41,9 +175,6 @@ bool VLCVideoReader::open(const std::string& video_path) {
         return false;
     }
     
-    // Parse media để lấy thông tin
-    libvlc_media_parse_with_options(media_, libvlc_media_parse_local, -1);
-    
     // Tạo media player
     media_player_ = libvlc_media_player_new_from_media(media_);
     if (!media_player_) {
@@ -55,120 +186,292 @@ bool VLCVideoReader::open(const std::string& video_path) {
         return false;
     }
     
-    // Lấy thông tin video
-    if (!initializeVideoInfo()) {
+    // Đăng ký callbacks/events và bắt đầu parse bất đồng bộ (không chờ)
+    if (!initializeVideoInfo(cached.get())) {
         std::cerr << "[ERROR] Không thể lấy thông tin video" << std::endl;
         release();
         return false;
     }
     
     is_opened_ = true;
+    
+    // Offline: bắt đầu decode ngay để frame đầu tiên sẵn sàng khi consumer gọi read().
+    // Không mất frame vì lock() chặn khi ring đầy. Ring (theo fps) vẫn đợi read() đầu tiên
+    // để không bị bỏ frame trong lúc consumer còn đang khởi tạo.
+    // Stream: nguồn không chờ ai, kết nối ngay để metadata (lấy khi có Vout) sẵn sàng sớm.
+    if (mode_ == DecodeMode::Offline || is_stream_) {
+        startPlayback();
+    }
     return true;
 }
 
-bool VLCVideoReader::initializeVideoInfo() {
+bool VLCVideoReader::initializeVideoInfo(const MediaInfo* cached) {
     if (!media_player_ || !media_) {
         return false;
     }
     
-    // Parse media để lấy thông tin (synchronous parse)
-    libvlc_media_parse_with_options(media_, libvlc_media_parse_local, -1);
-    
-    // Đợi media parse xong (có thể mất thời gian với file lớn)
-    int parse_attempts = 0;
-    while (parse_attempts < 50) {
-        libvlc_media_parsed_status_t parse_status = libvlc_media_get_parsed_status(media_);
-        if (parse_status == libvlc_media_parsed_status_done) {
-            break;
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        fps_ = 30.0; // Default FPS, cập nhật khi parse xong
+        if (cached && cached->parsed) {
+            frame_width_ = cached->width;
+            frame_height_ = cached->height;
+            fps_ = cached->fps;
+            total_frames_ = cached->total_frames;
+            parse_done_ = true;
+        }
+        if (hasIndex()) {
+            total_frames_ = index_->frameCount();
+            if (index_->frameDurationMs() > 0.0) {
+                fps_ = 1000.0 / index_->frameDurationMs();
+            }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        parse_attempts++;
     }
     
-    // Lấy FPS và kích thước từ media tracks trước (cách đáng tin cậy hơn)
+    // Set callback để lấy frame (format sẽ được setup trong format_setup callback)
+    libvlc_video_set_callbacks(media_player_, lock, unlock, display, this);
+    libvlc_video_set_format_callbacks(media_player_, format_setup, format_cleanup);
+    
+    // Lắng nghe sự kiện hết video / lỗi để đánh thức read() đang chờ trong chế độ Ring
+    libvlc_event_manager_t* events = libvlc_media_player_event_manager(media_player_);
+    libvlc_event_attach(events, libvlc_MediaPlayerEndReached, handle_event, this);
+    libvlc_event_attach(events, libvlc_MediaPlayerEncounteredError, handle_event, this);
+    libvlc_event_attach(events, libvlc_MediaPlayerVout, handle_event, this);
+    
+    if (cached && cached->parsed) {
+        return true; // Metadata lấy từ cache, không cần parse
+    }
+    if (is_stream_) {
+        // Parse stream = kết nối thêm 1 lần nữa; track info đọc khi VLC báo Vout (xem handle_event)
+        return true;
+    }
+    
+    // Metadata (kích thước, fps, duration) được điền khi VLC báo parse xong
+    libvlc_event_manager_t* media_events = libvlc_media_event_manager(media_);
+    libvlc_event_attach(media_events, libvlc_MediaParsedChanged, handle_event, this);
+    libvlc_event_attach(media_events, libvlc_MediaDurationChanged, handle_event, this);
+    
+    if (libvlc_media_parse_with_options(media_, libvlc_media_parse_local, Config::VLC_PARSE_TIMEOUT_MS) != 0) {
+        std::cerr << "[WARNING] VLC không bắt đầu parse được, metadata sẽ lấy từ frame đầu tiên" << std::endl;
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        parse_done_ = true;
+    }
+    
+    return true;
+}
+
+void VLCVideoReader::onParsed() {
+    // Lấy FPS và kích thước từ media tracks
     libvlc_media_track_t** tracks = nullptr;
-    unsigned int track_count = 0;
-    track_count = libvlc_media_tracks_get(media_, &tracks);
-    
-    fps_ = 30.0; // Default FPS
-    if (tracks && track_count > 0) {
-        for (unsigned int i = 0; i < track_count; i++) {
-            if (tracks[i]->i_type == libvlc_track_video) {
-                libvlc_video_track_t* video_track = tracks[i]->video;
-                if (video_track) {
-                    // Lấy kích thước từ track
-                    frame_width_ = video_track->i_width;
-                    frame_height_ = video_track->i_height;
-                    
-                    // Lấy FPS
-                    if (video_track->i_frame_rate_num > 0 && video_track->i_frame_rate_den > 0) {
-                        fps_ = static_cast<double>(video_track->i_frame_rate_num) / 
-                               static_cast<double>(video_track->i_frame_rate_den);
+    unsigned int track_count = libvlc_media_tracks_get(media_, &tracks);
+    libvlc_time_t duration_ms = libvlc_media_get_duration(media_);
+    
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        if (tracks && track_count > 0) {
+            for (unsigned int i = 0; i < track_count; i++) {
+                if (tracks[i]->i_type == libvlc_track_video) {
+                    libvlc_video_track_t* video_track = tracks[i]->video;
+                    if (video_track) {
+                        // Kích thước từ format_setup (kích thước thực khi decode) được ưu tiên hơn
+                        if (!format_known_) {
+                            frame_width_ = video_track->i_width;
+                            frame_height_ = video_track->i_height;
+                        }
+                        
+                        // Lấy FPS (frame index nếu có là chính xác hơn)
+                        if (!hasIndex() && video_track->i_frame_rate_num > 0 && video_track->i_frame_rate_den > 0) {
+                            fps_ = static_cast<double>(video_track->i_frame_rate_num) / 
+                                   static_cast<double>(video_track->i_frame_rate_den);
+                        }
                     }
+                    break;
                 }
-                break;
             }
         }
+        
+        // Tính tổng số frame dựa trên duration và fps (frame index nếu có là chính xác)
+        if (!hasIndex() && duration_ms > 0 && fps_ > 0) {
+            total_frames_ = static_cast<int>((duration_ms / 1000.0) * fps_);
+        }
+        parse_done_ = true;
+        
+        MediaInfo info;
+        info.parsed = true;
+        info.width = frame_width_;
+        info.height = frame_height_;
+        info.fps = fps_;
+        info.total_frames = total_frames_;
+        if (!is_stream_) {
+            media_cache_store(video_path_, info);
+        }
+    }
+    if (tracks) {
         libvlc_media_tracks_release(tracks, track_count);
     }
+    metadata_cv_.notify_all();
     
-    // Nếu chưa lấy được kích thước từ tracks, thử từ video_get_size
-    if (frame_width_ == 0 || frame_height_ == 0) {
-        unsigned int width = 0, height = 0;
-        libvlc_video_get_size(media_player_, 0, &width, &height);
-        if (width > 0 && height > 0) {
-            frame_width_ = width;
-            frame_height_ = height;
-        } else {
-            std::cerr << "[WARNING] Không thể lấy kích thước video, sử dụng giá trị mặc định" << std::endl;
-            frame_width_ = 1920;
-            frame_height_ = 1080;
+    std::cout << "[INFO] VLC - Parse xong sau " << cv::format("%.1f", elapsedSinceOpenMs()) << "ms"
+              << " - Duration: " << duration_ms << "ms, FPS: " << get(cv::CAP_PROP_FPS)
+              << ", Total frames: " << get(cv::CAP_PROP_FRAME_COUNT) << std::endl;
+}
+
+bool VLCVideoReader::waitForMetadata(int prop) const {
+    std::unique_lock<std::mutex> lock(metadata_mutex_);
+    auto ready = [this, prop] {
+        switch (prop) {
+            case cv::CAP_PROP_FRAME_WIDTH:
+            case cv::CAP_PROP_FRAME_HEIGHT:
+                // Kích thước: format_setup (chính xác) hoặc parse xong
+                return format_known_ || parse_done_;
+            default:
+                return parse_done_;
         }
+    };
+    return metadata_cv_.wait_for(lock, std::chrono::milliseconds(Config::VLC_PARSE_TIMEOUT_MS), ready);
+}
+
+double VLCVideoReader::elapsedSinceOpenMs() const {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_time_).count();
+}
+
+double VLCVideoReader::getTimeToFirstFrameMs() const {
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    return first_frame_ms_;
+}
+
+void VLCVideoReader::startPlayback() {
+    libvlc_media_player_play(media_player_);
+    if (mode_ == DecodeMode::Offline && !is_stream_) {
+        // Đẩy đồng hồ phát lên mức tối đa, tốc độ thực tế do backpressure của ring quyết định
+        libvlc_media_player_set_rate(media_player_, Config::VLC_OFFLINE_RATE);
     }
-    
-    // Lấy duration từ media (thử nhiều lần vì có thể chưa sẵn sàng ngay)
-    libvlc_time_t duration_ms = -1;
-    for (int attempt = 0; attempt < 20; attempt++) {
-        duration_ms = libvlc_media_get_duration(media_);
-        if (duration_ms > 0) {
+}
+
+void VLCVideoReader::handle_event(const libvlc_event_t* event, void* data) {
+    VLCVideoReader* reader = static_cast<VLCVideoReader*>(data);
+    switch (event->type) {
+        case libvlc_MediaPlayerEndReached:
+        case libvlc_MediaPlayerEncounteredError: {
+            RingState& ring = *reader->ring_;
+            {
+                std::lock_guard<std::mutex> lock(ring.mutex);
+                ring.end_of_stream = true;
+            }
+            ring.frame_cv.notify_all();
             break;
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    }
-    
-    // Nếu vẫn không có duration, thử play video một chút để VLC có thể lấy được
-    if (duration_ms <= 0) {
-        libvlc_media_player_play(media_player_);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        
-        for (int attempt = 0; attempt < 10; attempt++) {
-            duration_ms = libvlc_media_get_duration(media_);
-            if (duration_ms > 0) {
-                break;
+        case libvlc_MediaParsedChanged:
+            reader->onParsed();
+            break;
+        case libvlc_MediaDurationChanged: {
+            int64_t duration_ms = event->u.media_duration_changed.new_duration;
+            std::lock_guard<std::mutex> lock(reader->metadata_mutex_);
+            if (!reader->hasIndex() && duration_ms > 0 && reader->fps_ > 0) {
+                reader->total_frames_ = static_cast<int>((duration_ms / 1000.0) * reader->fps_);
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            break;
         }
-        
-        libvlc_media_player_stop(media_player_);
+        case libvlc_MediaPlayerVout:
+            std::cout << "[INFO] VLC - Vout sẵn sàng sau " << cv::format("%.1f", reader->elapsedSinceOpenMs())
+                      << "ms" << std::endl;
+            if (reader->is_stream_) {
+                reader->onParsed();  // Stream: track đã được demux nhận diện khi có Vout
+            }
+            break;
+        default:
+            break;
     }
-    
-    // Tính tổng số frame dựa trên duration và fps
-    if (duration_ms > 0 && fps_ > 0) {
-        total_frames_ = static_cast<int>((duration_ms / 1000.0) * fps_);
-        std::cout << "[INFO] VLC - Duration: " << duration_ms << "ms, FPS: " << fps_ 
-                  << ", Total frames: " << total_frames_ << std::endl;
-    } else {
-        std::cerr << "[WARNING] Không thể lấy duration video (duration=" << duration_ms 
-                  << "ms, fps=" << fps_ << ")" << std::endl;
-        std::cerr << "[WARNING] Tổng số frame sẽ là 0, tiến độ có thể không chính xác" << std::endl;
-        total_frames_ = 0; // Sẽ không thể tính progress chính xác
+}
+
+void VLCVideoReader::RingState::returnSlot(int slot, uint64_t slot_generation) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Ring đã được cấp phát lại (format_setup/release) -> slot cũ không còn thuộc pool
+        if (slot_generation != generation) {
+            return;
+        }
+        free_slots.push_back(slot);
     }
-    
-    // Set callback để lấy frame (format sẽ được setup trong format_setup callback)
-    libvlc_video_set_callbacks(media_player_, lock, unlock, display, this);
-    libvlc_video_set_format_callbacks(media_player_, format_setup, format_cleanup);
-    
-    return true;
+    slot_free_cv.notify_one();
+}
+
+size_t VLCVideoReader::RingState::reclaimLost(std::chrono::steady_clock::time_point now) {
+    // Gọi khi đang giữ mutex. display() sau này của ảnh đã lấy lại không còn tìm thấy id -> bị bỏ qua
+    const auto timeout = std::chrono::milliseconds(Config::VLC_LOST_PICTURE_MS);
+    size_t reclaimed = 0;
+    for (auto it = locked.begin(); it != locked.end();) {
+        if (now - it->locked_at < timeout) {
+            ++it;
+            continue;
+        }
+        if (it->slot >= 0) {
+            free_slots.push_back(it->slot);
+        }
+        it = locked.erase(it);
+        reclaimed++;
+    }
+    return reclaimed;
+}
+
+void VLCVideoReader::setDecodeMode(DecodeMode mode, size_t ring_slots) {
+    mode_ = mode;
+    ring_capacity_ = std::max<size_t>(ring_slots, 2);
+    drop_policy_ = (mode == DecodeMode::Offline) ? DropPolicy::Block : DropPolicy::DropOldest;
+}
+
+void VLCVideoReader::setDropPolicy(DropPolicy policy) {
+    drop_policy_ = policy;
+}
+
+bool VLCVideoReader::isStreamUrl(const std::string& path) {
+    size_t scheme_end = path.find("://");
+    if (scheme_end == std::string::npos || scheme_end == 0) {
+        return false;
+    }
+    return path.compare(0, scheme_end, "file") != 0;
+}
+
+void VLCVideoReader::setPixelLayout(PixelLayout layout) {
+    layout_ = layout;
+}
+
+void VLCVideoReader::setUseFrameIndex(bool enabled) {
+    use_index_ = enabled;
+}
+
+void VLCVideoReader::flushRing() {
+    // Bỏ các frame đã decode nhưng chưa đọc (ví dụ: frame trước vị trí seek)
+    RingState& ring = *ring_;
+    {
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        for (int slot : ring.ready_slots) {
+            ring.free_slots.push_back(slot);
+        }
+        ring.ready_slots.clear();
+    }
+    ring.slot_free_cv.notify_all();
+}
+
+uint64_t VLCVideoReader::getDecodedFrames() const {
+    return decoded_frames_;
+}
+
+uint64_t VLCVideoReader::getDroppedFrames() const {
+    return dropped_frames_;
+}
+
+uint64_t VLCVideoReader::getLateFrames() const {
+    return late_frames_;
+}
+
+double VLCVideoReader::getDecodeFps() const {
+    std::lock_guard<std::mutex> lock(ring_->mutex);
+    if (decoded_frames_ < 2) {
+        return 0.0;
+    }
+    double elapsed = std::chrono::duration<double>(ring_->last_frame_time - ring_->first_frame_time).count();
+    return elapsed > 0.0 ? (decoded_frames_ - 1) / elapsed : 0.0;
 }
 
 bool VLCVideoReader::isOpened() const {
@@ -178,23 +481,91 @@ bool VLCVideoReader::isOpened() const {
 unsigned VLCVideoReader::format_setup(void** opaque, char* chroma, unsigned* width, unsigned* height, unsigned* pitches, unsigned* lines) {
     VLCVideoReader* reader = static_cast<VLCVideoReader*>(*opaque);
     
-    // Set chroma format (RGB24 - reversed byte order for VLC)
-    memcpy(chroma, "RV24", 4);
+    // Set chroma format
+    // RV24: RGB24 (reversed byte order for VLC). libVLC 4 có thêm BGR3 -> xin thẳng BGR
+    // khi consumer cần BGR để bỏ bước đảo kênh. libVLC 3 không có BGR3 nên vẫn dùng RV24.
+    // I420/NV12: VLC giao thẳng output của decoder (thường đã là YUV 4:2:0), không convert sang RGB.
+    reader->vlc_layout_ = PixelLayout::RGB;
+    if (reader->usesRing() && reader->layout_ == PixelLayout::I420) {
+        memcpy(chroma, "I420", 4);
+        reader->vlc_layout_ = PixelLayout::I420;
+    } else if (reader->usesRing() && reader->layout_ == PixelLayout::NV12) {
+        memcpy(chroma, "NV12", 4);
+        reader->vlc_layout_ = PixelLayout::NV12;
+    } else if (reader->usesRing() && reader->layout_ == PixelLayout::BGR && std::atoi(libvlc_get_version()) >= 4) {
+        memcpy(chroma, "BGR3", 4);
+        reader->vlc_layout_ = PixelLayout::BGR;
+    } else {
+        memcpy(chroma, "RV24", 4);
+    }
+    bool planar = isPlanar(reader->vlc_layout_);
     
     // Use dimensions provided by VLC (these are the actual video dimensions)
-    reader->frame_width_ = *width;
-    reader->frame_height_ = *height;
+    {
+        std::lock_guard<std::mutex> lock(reader->metadata_mutex_);
+        reader->frame_width_ = *width;
+        reader->frame_height_ = *height;
+        reader->format_known_ = true;
+    }
+    reader->metadata_cv_.notify_all();
+    
+    // Có output size (ví dụ input của model): xin VLC giao frame đã thu nhỏ sẵn vào khung đó, giữ
+    // tỉ lệ. VLC chèn bộ scale vào chuỗi convert chroma -> pool, copy và cvtColor phía sau chỉ đụng
+    // tới pixel model dùng.
+    cv::Size out_size = reader->outputFrameSize(cv::Size(static_cast<int>(*width), static_cast<int>(*height)));
+    unsigned out_width = static_cast<unsigned>(out_size.width);
+    unsigned out_height = static_cast<unsigned>(out_size.height);
+    if (planar) {
+        // Chroma 4:2:0 cần kích thước chẵn (VLC scale đi 1 pixel nếu video có kích thước lẻ)
+        out_width &= ~1u;
+        out_height &= ~1u;
+    }
+    *width = out_width;
+    *height = out_height;
+    
+    // Planar: mỗi buffer là 1 Mat liên tục cao h*3/2 (Y rồi tới U,V hoặc UV)
+    int buffer_rows = planar ? static_cast<int>(out_height * 3 / 2) : static_cast<int>(out_height);
+    int buffer_cols = static_cast<int>(out_width);
+    int buffer_type = planar ? CV_8UC1 : CV_8UC3;
     
     // Allocate frame buffer
-    {
+    if (reader->usesRing()) {
+        // Cấp phát sẵn toàn bộ slot của pool, callbacks không cấp phát thêm gì
+        RingState& ring = *reader->ring_;
+        std::lock_guard<std::mutex> lock(ring.mutex);
+        ring.generation++;
+        ring.slots.clear();
+        ring.free_slots.clear();
+        ring.ready_slots.clear();
+        ring.locked.clear();
+        ring.slot_frame_numbers.assign(reader->ring_capacity_, -1);
+        ring.slot_display_times.assign(reader->ring_capacity_, std::chrono::steady_clock::time_point());
+        for (size_t i = 0; i < reader->ring_capacity_; i++) {
+            ring.slots.emplace_back(buffer_rows, buffer_cols, buffer_type);
+            ring.free_slots.push_back(static_cast<int>(i));
+        }
+        ring.scratch = cv::Mat(buffer_rows, buffer_cols, buffer_type);
+    } else {
         std::lock_guard<std::mutex> lock(reader->frame_mutex_);
-        reader->frame_buffer_ = cv::Mat(reader->frame_height_, reader->frame_width_, CV_8UC3);
+        reader->frame_buffer_ = cv::Mat(out_height, out_width, CV_8UC3);
     }
     
     // Set pitches and lines (pitch = bytes per line)
-    unsigned pitch = reader->frame_width_ * 3; // RGB24 = 3 bytes per pixel
-    *pitches = pitch;
-    *lines = reader->frame_height_;
+    if (planar) {
+        pitches[0] = out_width;
+        lines[0] = out_height;
+        if (reader->vlc_layout_ == PixelLayout::I420) {
+            pitches[1] = pitches[2] = out_width / 2;
+            lines[1] = lines[2] = out_height / 2;
+        } else {
+            pitches[1] = out_width;  // UV xen kẽ: w/2 cặp byte mỗi dòng
+            lines[1] = out_height / 2;
+        }
+    } else {
+        unsigned pitch = out_width * 3; // RGB24 = 3 bytes per pixel
+        *pitches = pitch;
+        *lines = out_height;
+    }
     
     reader->format_setup_ = true;
     
@@ -207,6 +578,45 @@ void VLCVideoReader::format_cleanup(void* opaque) {
 
 void* VLCVideoReader::lock(void* data, void** p_pixels) {
     VLCVideoReader* reader = static_cast<VLCVideoReader*>(data);
+    
+    if (reader->usesRing()) {
+        RingState& ring = *reader->ring_;
+        std::unique_lock<std::mutex> guard(ring.mutex);
+        // Không slot trống, không frame chờ đọc: có thể VLC đã bỏ ảnh lock trước đó mà không display
+        auto reclaim_if_starved = [&]() {
+            if (ring.free_slots.empty() && ring.ready_slots.empty()) {
+                reader->dropped_frames_ += ring.reclaimLost(std::chrono::steady_clock::now());
+            }
+        };
+        reclaim_if_starved();
+        if (reader->drop_policy_ == DropPolicy::Block) {
+            // Backpressure: đợi consumer trả slot thay vì ghi đè frame chưa đọc.
+            // Chờ có hạn để slot của ảnh bị bỏ vẫn được lấy lại khi consumer không trả slot nào
+            const auto timeout = std::chrono::milliseconds(Config::VLC_LOST_PICTURE_MS);
+            while (ring.free_slots.empty() && !ring.stopping) {
+                ring.slot_free_cv.wait_for(guard, timeout);
+                reclaim_if_starved();
+            }
+        }
+        
+        int slot = -1;
+        if (!ring.free_slots.empty()) {
+            slot = ring.free_slots.back();
+            ring.free_slots.pop_back();
+        } else if (!ring.ready_slots.empty()) {
+            // Ring đầy: ghi đè frame cũ nhất chưa được đọc
+            slot = ring.ready_slots.front();
+            ring.ready_slots.pop_front();
+            reader->dropped_frames_++;
+        }
+        
+        // slot == -1: consumer đang giữ hết slot -> decode vào scratch, frame này sẽ bị bỏ
+        setPlanePointers((slot >= 0) ? ring.slots[slot] : ring.scratch, reader->vlc_layout_, p_pixels);
+        uint64_t id = ring.next_picture_id++;
+        ring.locked.push_back({ id, slot, std::chrono::steady_clock::now() });
+        return reinterpret_cast<void*>(static_cast<uintptr_t>(id));
+    }
+    
     reader->frame_mutex_.lock();
     
     if (!reader->frame_buffer_.empty()) {
@@ -218,12 +628,70 @@ void* VLCVideoReader::lock(void* data, void** p_pixels) {
 
 void VLCVideoReader::unlock(void* data, void* id, void* const* p_pixels) {
     VLCVideoReader* reader = static_cast<VLCVideoReader*>(data);
+    if (reader->usesRing()) {
+        // Frame chỉ được đưa vào ring khi display() được gọi
+        return;
+    }
     reader->frame_ready_ = true;
     reader->frame_mutex_.unlock();
 }
 
 void VLCVideoReader::display(void* data, void* id) {
-    // Frame displayed, can be used for synchronization if needed
+    VLCVideoReader* reader = static_cast<VLCVideoReader*>(data);
+    if (!reader->usesRing()) {
+        return;
+    }
+    
+    RingState& ring = *reader->ring_;
+    const uint64_t picture_id = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(id));
+    
+    bool first_frame = false;
+    {
+        std::unique_lock<std::mutex> guard(ring.mutex);
+        auto locked = std::find_if(ring.locked.begin(), ring.locked.end(),
+                                   [picture_id](const RingState::LockedPicture& p) { return p.id == picture_id; });
+        if (locked == ring.locked.end()) {
+            // Ảnh từ trước seek / cấp phát lại ring, hoặc đã bị lấy lại vì coi là mất -> slot không còn của ảnh này
+            return;
+        }
+        const int slot = locked->slot;
+        ring.locked.erase(locked);
+        // Frame bị bỏ vẫn chiếm 1 số thứ tự để vị trí frame luôn chính xác
+        int64_t frame_number = ring.next_frame_number++;
+        if (ring.seek_pending) {
+            if (frame_number < ring.seek_target) {
+                // Frame từ keyframe tới trước frame đích: chỉ để decode, bỏ (không tính là frame bị bỏ)
+                if (slot >= 0) {
+                    ring.free_slots.push_back(slot);
+                    guard.unlock();
+                    ring.slot_free_cv.notify_one();
+                }
+                return;
+            }
+            // Đúng frame đích, hoặc trễ hơn (seekToFrame báo lỗi, số thứ tự vẫn đúng)
+            ring.seek_pending = false;
+            ring.seek_landed = frame_number;
+            ring.frame_cv.notify_all();
+        }
+        if (slot < 0) {
+            reader->dropped_frames_++;
+            return;
+        }
+        ring.slot_frame_numbers[slot] = frame_number;
+        ring.ready_slots.push_back(slot);
+        ring.last_frame_time = std::chrono::steady_clock::now();
+        ring.slot_display_times[slot] = ring.last_frame_time;
+        if (reader->decoded_frames_ == 0) {
+            ring.first_frame_time = ring.last_frame_time;
+            first_frame = true;
+        }
+        reader->decoded_frames_++;
+    }
+    if (first_frame) {
+        std::lock_guard<std::mutex> lock(reader->metadata_mutex_);
+        reader->first_frame_ms_ = reader->elapsedSinceOpenMs();
+    }
+    ring.frame_cv.notify_one();
 }
 
 bool VLCVideoReader::read(cv::Mat& frame) {
@@ -231,6 +699,151 @@ bool VLCVideoReader::read(cv::Mat& frame) {
         return false;
     }
     
+    if (usesRing()) {
+        return readRing(frame);
+    }
+    return readStepped(frame);
+}
+
+bool VLCVideoReader::acquireSlot(FrameLease& lease) {
+    lease.release();
+    
+    // Lần đọc đầu tiên: bắt đầu play, sau đó VLC chạy liên tục không pause
+    libvlc_state_t state = libvlc_media_player_get_state(media_player_);
+    if (state == libvlc_NothingSpecial || state == libvlc_Stopped) {
+        startPlayback();
+    }
+    
+    // Frame chờ trong ring lâu hơn 1 chu kỳ frame = consumer đang tụt lại sau nguồn
+    std::chrono::duration<double, std::milli> late_after(1000.0 / 30.0);
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        if (fps_ > 0.0) {
+            late_after = std::chrono::duration<double, std::milli>(1000.0 / fps_);
+        }
+    }
+    
+    std::shared_ptr<RingState> ring = ring_;
+    std::unique_lock<std::mutex> lock(ring->mutex);
+    // Timeout chỉ để tránh treo vĩnh viễn nếu VLC không gửi frame nào (giống giới hạn 5s cũ)
+    bool ok = ring->frame_cv.wait_for(lock, std::chrono::seconds(5), [&ring] {
+        return !ring->ready_slots.empty() || ring->end_of_stream;
+    });
+    
+    if (!ok) {
+        std::cerr << "[WARNING] Timeout waiting for frame to be ready" << std::endl;
+        return false;
+    }
+    if (ring->ready_slots.empty()) {
+        return false; // Hết video hoặc lỗi
+    }
+    
+    if (drop_policy_ == DropPolicy::KeepLatest && ring->ready_slots.size() > 1) {
+        // Chỉ giữ frame mới nhất, các frame cũ hơn trả lại pool
+        while (ring->ready_slots.size() > 1) {
+            ring->free_slots.push_back(ring->ready_slots.front());
+            ring->ready_slots.pop_front();
+            dropped_frames_++;
+        }
+        ring->slot_free_cv.notify_all();
+    }
+    
+    int slot = ring->ready_slots.front();
+    ring->ready_slots.pop_front();
+    uint64_t generation = ring->generation;
+    if (mode_ == DecodeMode::Ring && std::chrono::steady_clock::now() - ring->slot_display_times[slot] > late_after) {
+        late_frames_++;
+    }
+    
+    // Header giữ refcount của buffer phòng khi format_setup cấp phát lại pool.
+    // Slot không nằm trong free_slots nên VLC không ghi đè cho tới khi lease được trả.
+    int64_t frame_number = ring->slot_frame_numbers[slot];
+    position_ = frame_number + 1;
+    lease = FrameLease(ring->slots[slot], frame_number,
+                       std::shared_ptr<void>(nullptr, [ring, slot, generation](void*) {
+                           ring->returnSlot(slot, generation);
+                       }));
+    return true;
+}
+
+bool VLCVideoReader::readLease(FrameLease& lease) {
+    if (!isOpened()) {
+        return false;
+    }
+    if (!usesRing()) {
+        return FrameSource::readLease(lease); // Stepped: copy như read()
+    }
+    if (!acquireSlot(lease)) {
+        return false;
+    }
+    
+    // Chỉ xảy ra khi VLC không ghi được đúng layout (BGR trên libVLC 3):
+    // đảo kênh tại chỗ trên buffer của slot, không cấp phát/copy thêm
+    if (!isPlanar(layout_) && vlc_layout_ != layout_) {
+        cv::Mat pixels = lease.mat();  // Header dùng chung buffer với slot
+        cv::cvtColor(pixels, pixels, cv::COLOR_RGB2BGR);
+    }
+    return true;
+}
+
+bool VLCVideoReader::readRing(cv::Mat& frame) {
+    FrameLease lease;
+    if (!acquireSlot(lease)) {
+        return false;
+    }
+    
+    // Convert ngoài lock để không chặn thread decode của VLC; read() trả BGR (RGB nếu layout_ là RGB)
+    switch (vlc_layout_) {
+        case PixelLayout::BGR:
+        case PixelLayout::RGB:
+            if (vlc_layout_ == layout_) {
+                lease.mat().copyTo(frame);
+            } else {
+                cv::cvtColor(lease.mat(), frame, cv::COLOR_RGB2BGR);
+            }
+            break;
+        case PixelLayout::I420:
+            cv::cvtColor(lease.mat(), frame, cv::COLOR_YUV2BGR_I420);
+            break;
+        case PixelLayout::NV12:
+            cv::cvtColor(lease.mat(), frame, cv::COLOR_YUV2BGR_NV12);
+            break;
+    }
+    return true;
+}
+
+void VLCVideoReader::setPlanePointers(const cv::Mat& buffer, PixelLayout layout, void** p_pixels) {
+    p_pixels[0] = buffer.data;
+    if (!isPlanar(layout)) {
+        return;
+    }
+    size_t luma_bytes = static_cast<size_t>(buffer.cols) * (buffer.rows * 2 / 3);
+    p_pixels[1] = buffer.data + luma_bytes;
+    if (layout == PixelLayout::I420) {
+        p_pixels[2] = buffer.data + luma_bytes + luma_bytes / 4;
+    }
+}
+
+VLCVideoReader::YUVPlanes VLCVideoReader::planes(const cv::Mat& frame, PixelLayout layout) {
+    YUVPlanes result;
+    if (frame.empty() || !isPlanar(layout) || frame.type() != CV_8UC1 || !frame.isContinuous()) {
+        return result;
+    }
+    int width = frame.cols;
+    int height = frame.rows * 2 / 3;
+    size_t luma_bytes = static_cast<size_t>(width) * height;
+    
+    result.y = frame.rowRange(0, height);
+    if (layout == PixelLayout::I420) {
+        result.u = cv::Mat(height / 2, width / 2, CV_8UC1, frame.data + luma_bytes);
+        result.v = cv::Mat(height / 2, width / 2, CV_8UC1, frame.data + luma_bytes + luma_bytes / 4);
+    } else {
+        result.uv = cv::Mat(height / 2, width / 2, CV_8UC2, frame.data + luma_bytes);
+    }
+    return result;
+}
+
+bool VLCVideoReader::readStepped(cv::Mat& frame) {
     // Start playing if paused or stopped
     libvlc_state_t state = libvlc_media_player_get_state(media_player_);
     
@@ -310,8 +923,12 @@ bool VLCVideoReader::read(cv::Mat& frame) {
     {
         std::lock_guard<std::mutex> lock(frame_mutex_);
         if (!frame_buffer_.empty()) {
-            // VLC provides RGB24, convert to BGR for OpenCV
-            cv::cvtColor(frame_buffer_, frame, cv::COLOR_RGB2BGR);
+            // VLC provides RGB24, convert to BGR for OpenCV (consumer xin RGB thì copy thẳng)
+            if (layout_ == PixelLayout::RGB) {
+                frame_buffer_.copyTo(frame);
+            } else {
+                cv::cvtColor(frame_buffer_, frame, cv::COLOR_RGB2BGR);
+            }
             
             // Pause video after reading frame to allow step-by-step reading
             libvlc_media_player_set_pause(media_player_, 1);
@@ -323,6 +940,15 @@ bool VLCVideoReader::read(cv::Mat& frame) {
     return false;
 }
 
+cv::Size VLCVideoReader::nativeFrameSize() const {
+    if (!isOpened()) {
+        return cv::Size();
+    }
+    waitForMetadata(cv::CAP_PROP_FRAME_WIDTH);
+    std::lock_guard<std::mutex> lock(metadata_mutex_);
+    return cv::Size(static_cast<int>(frame_width_), static_cast<int>(frame_height_));
+}
+
 double VLCVideoReader::get(int prop) const {
     if (!isOpened()) {
         return -1.0;
@@ -330,15 +956,28 @@ double VLCVideoReader::get(int prop) const {
     
     switch (prop) {
         case cv::CAP_PROP_FRAME_WIDTH:
-            return static_cast<double>(frame_width_);
         case cv::CAP_PROP_FRAME_HEIGHT:
-            return static_cast<double>(frame_height_);
         case cv::CAP_PROP_FPS:
-            return fps_;
-        case cv::CAP_PROP_FRAME_COUNT:
+        case cv::CAP_PROP_FRAME_COUNT: {
+            // Metadata được điền bất đồng bộ: chỉ chờ (có giới hạn) khi thật sự cần
+            if (!waitForMetadata(prop)) {
+                std::cerr << "[WARNING] VLC chưa có metadata sau " << Config::VLC_PARSE_TIMEOUT_MS
+                          << "ms, dùng giá trị hiện có" << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(metadata_mutex_);
+            // Frame đã scale trong decoder: kích thước trả ra là kích thước gốc thu nhỏ vào khung output
+            cv::Size size = outputFrameSize(cv::Size(static_cast<int>(frame_width_), static_cast<int>(frame_height_)));
+            if (prop == cv::CAP_PROP_FRAME_WIDTH) return static_cast<double>(size.width);
+            if (prop == cv::CAP_PROP_FRAME_HEIGHT) return static_cast<double>(size.height);
+            if (prop == cv::CAP_PROP_FPS) return fps_;
             return static_cast<double>(total_frames_);
+        }
         case cv::CAP_PROP_POS_FRAMES: {
             if (!media_player_) return -1.0;
+            if (usesRing()) {
+                // Đếm chính xác theo frame đã giao (gồm cả frame bị bỏ)
+                return static_cast<double>(position_);
+            }
             libvlc_time_t time_ms = libvlc_media_player_get_time(media_player_);
             if (time_ms > 0 && fps_ > 0) {
                 return (time_ms / 1000.0) * fps_;
@@ -347,6 +986,9 @@ double VLCVideoReader::get(int prop) const {
         }
         case cv::CAP_PROP_POS_MSEC: {
             if (!media_player_) return -1.0;
+            if (usesRing() && hasIndex()) {
+                return index_->ptsMs(static_cast<int>(position_));
+            }
             return static_cast<double>(libvlc_media_player_get_time(media_player_));
         }
         default:
@@ -361,19 +1003,27 @@ bool VLCVideoReader::set(int prop, double value) {
     
     switch (prop) {
         case cv::CAP_PROP_POS_FRAMES: {
+            if (usesRing() && ensureIndex()) {
+                return seekToFrame(static_cast<int>(value));
+            }
             if (fps_ > 0) {
                 libvlc_time_t time_ms = static_cast<libvlc_time_t>((value / fps_) * 1000.0);
                 libvlc_media_player_set_time(media_player_, time_ms);
                 // Reset frame ready flag after seeking
                 frame_ready_ = false;
+                flushRing();
                 std::this_thread::sleep_for(std::chrono::milliseconds(50));
                 return true;
             }
             return false;
         }
         case cv::CAP_PROP_POS_MSEC: {
+            if (usesRing() && ensureIndex()) {
+                return seekToFrame(index_->frameAtTime(value));
+            }
             libvlc_media_player_set_time(media_player_, static_cast<libvlc_time_t>(value));
             frame_ready_ = false;
+            flushRing();
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             return true;
         }
@@ -382,14 +1032,103 @@ bool VLCVideoReader::set(int prop, double value) {
     }
 }
 
+bool VLCVideoReader::seekToFrame(int frame_number) {
+    if (frame_number < 0 || frame_number >= index_->frameCount()) {
+        return false;
+    }
+    const int keyframe = index_->keyframeBefore(frame_number);
+    
+    // Dừng player (đánh thức lock() nếu đang chờ slot ở chế độ Offline)
+    {
+        std::lock_guard<std::mutex> lock(ring_->mutex);
+        ring_->stopping = true;
+    }
+    ring_->slot_free_cv.notify_all();
+    libvlc_media_player_stop(media_player_);
+    
+    {
+        std::lock_guard<std::mutex> lock(ring_->mutex);
+        for (int slot : ring_->ready_slots) {
+            ring_->free_slots.push_back(slot);
+        }
+        ring_->ready_slots.clear();
+        // Player đã dừng: ảnh đang lock sẽ không được display nữa
+        for (const RingState::LockedPicture& picture : ring_->locked) {
+            if (picture.slot >= 0) {
+                ring_->free_slots.push_back(picture.slot);
+            }
+        }
+        ring_->locked.clear();
+        ring_->stopping = false;
+        ring_->end_of_stream = false;
+        ring_->next_frame_number = keyframe;
+        ring_->seek_pending = true;
+        ring_->seek_target = frame_number;
+        ring_->seek_landed = -1;
+    }
+    
+    // start-time: VLC demux từ keyframe <= start-time, decode và chỉ hiển thị frame có PTS >= start-time.
+    // Đặt start-time vào giữa PTS của frame trước keyframe và keyframe -> frame hiển thị đầu tiên chính
+    // là keyframe, số thứ tự đếm tiếp theo index (không dựa vào đồng hồ phát), display() bỏ các frame
+    // trước frame đích. Media mới mỗi lần seek: option gắn vào media cộng dồn, không gỡ được
+    double start_ms = (keyframe > 0) ? (index_->ptsMs(keyframe - 1) + index_->ptsMs(keyframe)) / 2.0 : 0.0;
+    libvlc_media_t* media = createMedia(start_ms / 1000.0);
+    if (!media) {
+        std::cerr << "[ERROR] Không thể tạo VLC media để seek: " << video_path_ << std::endl;
+        return false;
+    }
+    // Parse (nếu còn chạy) đọc media_ trên thread của VLC -> chờ xong rồi mới thay
+    waitForMetadata(cv::CAP_PROP_FRAME_COUNT);
+    libvlc_event_manager_t* media_events = libvlc_media_event_manager(media_);
+    libvlc_event_detach(media_events, libvlc_MediaParsedChanged, handle_event, this);
+    libvlc_event_detach(media_events, libvlc_MediaDurationChanged, handle_event, this);
+    libvlc_media_parse_stop(media_);
+    libvlc_media_release(media_);
+    media_ = media;
+    libvlc_media_player_set_media(media_player_, media_);
+    
+    std::cout << "[INFO] Seek tới frame " << frame_number << " (keyframe " << keyframe
+              << ", decode thêm " << (frame_number - keyframe) << " frame)" << std::endl;
+    
+    // Chờ frame đầu tiên được giữ lại (display() bỏ các frame trước frame đích)
+    startPlayback();
+    std::shared_ptr<RingState> ring = ring_;
+    std::unique_lock<std::mutex> lock(ring->mutex);
+    ring->frame_cv.wait_for(lock, std::chrono::seconds(5), [&ring] {
+        return !ring->seek_pending || ring->end_of_stream;
+    });
+    if (ring->seek_pending) {
+        ring->seek_pending = false;
+        std::cerr << "[ERROR] Seek tới frame " << frame_number << ": VLC không giao frame nào" << std::endl;
+        return false;
+    }
+    position_ = ring->seek_landed;
+    if (ring->seek_landed != frame_number) {
+        std::cerr << "[ERROR] Seek tới frame " << frame_number << " nhưng VLC bắt đầu từ frame "
+                  << ring->seek_landed << " (sau frame đích)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void VLCVideoReader::release() {
     if (media_player_) {
+        // Đánh thức lock() nếu đang chặn chờ slot, nếu không stop() sẽ treo
+        {
+            std::lock_guard<std::mutex> lock(ring_->mutex);
+            ring_->stopping = true;
+        }
+        ring_->slot_free_cv.notify_all();
         libvlc_media_player_stop(media_player_);
         libvlc_media_player_release(media_player_);
         media_player_ = nullptr;
     }
     
     if (media_) {
+        libvlc_event_manager_t* media_events = libvlc_media_event_manager(media_);
+        libvlc_event_detach(media_events, libvlc_MediaParsedChanged, handle_event, this);
+        libvlc_event_detach(media_events, libvlc_MediaDurationChanged, handle_event, this);
+        libvlc_media_parse_stop(media_);
         libvlc_media_release(media_);
         media_ = nullptr;
     }
@@ -403,10 +1142,30 @@ void VLCVideoReader::release() {
     frame_ready_ = false;
     format_setup_ = false;
     
+    {
+        std::lock_guard<std::mutex> lock(metadata_mutex_);
+        parse_done_ = false;
+        format_known_ = false;
+        first_frame_ms_ = -1.0;
+        frame_width_ = 0;
+        frame_height_ = 0;
+        total_frames_ = 0;
+    }
+    
     {
         std::lock_guard<std::mutex> lock(frame_mutex_);
         frame_buffer_.release();
     }
+    
+    // Pool mới cho lần open() sau; lease còn sống vẫn giữ pool cũ cho tới khi được trả
+    ring_ = std::make_shared<RingState>();
+    position_ = 0;
+    index_.reset();
+    video_path_.clear();
+    decoded_frames_ = 0;
+    dropped_frames_ = 0;
+    late_frames_ = 0;
+    is_stream_ = false;
 }
 
 VLCVideoReader& VLCVideoReader::operator>>(cv::Mat& frame) {
@@ -5,88 +5,399 @@
 #include <vlc/vlc.h>
 #include <mutex>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include "frame_index.hpp"
+#include "frame_source.hpp"
 
 /**
  * @brief VLC Video Reader - Wrapper class để đọc video bằng VLC thay vì OpenCV
  * 
- * Class này cung cấp interface tương tự cv::VideoCapture nhưng sử dụng libVLC
+ * Class này cung cấp interface tương tự cv::VideoCapture (qua FrameSource) nhưng sử dụng libVLC
  * để đọc video. Frames được convert sang cv::Mat để tương thích với code hiện tại.
  */
-class VLCVideoReader {
+class VLCVideoReader : public FrameSource {
 public:
+    /**
+     * @brief Chế độ lấy frame từ VLC
+     * - Stepped: resume -> đợi 1 frame -> pause (chế độ cũ, chậm, giữ lại để so sánh)
+     * - Ring: VLC chạy liên tục, callbacks ghi vào ring các slot cấp phát sẵn,
+     *   read() chờ trên condition variable (không sleep, không pause)
+     * - Offline: như Ring nhưng không bám theo đồng hồ phát (rate cao, không bỏ frame trễ)
+     *   và lock() chặn khi ring đầy -> decode nhanh nhất có thể, giữ đủ mọi frame theo thứ tự
+     */
+    enum class DecodeMode {
+        Stepped,
+        Ring,
+        Offline
+    };
+
+    /**
+     * @brief Xử lý khi consumer chậm hơn nguồn (ring đầy / frame dồn lại)
+     * - DropOldest: VLC ghi đè frame cũ nhất chưa đọc (mặc định của Ring)
+     * - KeepLatest: như DropOldest, thêm nữa read() bỏ mọi frame đang chờ trừ frame mới nhất
+     *   -> độ trễ thấp nhất cho camera live
+     * - Block: lock() chờ consumer trả slot, không mất frame (mặc định của Offline).
+     *   Với stream live, VLC sẽ dồn dữ liệu vào buffer mạng rồi tự bỏ khi tràn.
+     */
+    enum class DropPolicy {
+        DropOldest,
+        KeepLatest,
+        Block
+    };
+
+    /**
+     * @brief Layout pixel mà consumer muốn nhận từ readLease()
+     * Reader sẽ xin VLC chroma khớp với layout này để khỏi phải đảo kênh / convert
+     * 
+     * I420/NV12 (chỉ Ring/Offline): lease là 1 Mat CV_8UC1 liên tục, cao h*3/2 (Y rồi tới
+     * chroma), một nửa số byte so với RGB 24-bit. Dùng planes() để lấy view từng plane.
+     * read() trả RGB với layout RGB, còn lại luôn trả BGR.
+     */
+    enum class PixelLayout {
+        BGR,   // OpenCV (VideoWriter, vẽ annotation)
+        RGB,   // Đầu vào DNN (Letterbox::InputTensor với ChannelOrder::RGB), xin thẳng RV24 trên mọi libVLC
+        I420,  // Y, U, V tách riêng (U/V ở nửa độ phân giải)
+        NV12   // Y, UV xen kẽ
+    };
+    
+    /**
+     * @brief View (không copy) lên từng plane của frame YUV
+     * I420: y, u, v. NV12: y, uv (CV_8UC2). Plane không có trong layout thì rỗng.
+     */
+    struct YUVPlanes {
+        cv::Mat y;
+        cv::Mat u;
+        cv::Mat v;
+        cv::Mat uv;
+    };
+
     VLCVideoReader();
-    ~VLCVideoReader();
+    ~VLCVideoReader() override;
     
     /**
-     * @brief Mở video file
-     * @param video_path Đường dẫn đến file video
+     * @brief Mở video file hoặc stream
+     * @param video_path Đường dẫn file, hoặc URL (rtsp://, udp://, http://, ...) cho camera live.
+     *        Stream: không parse / không frame index, bắt đầu nhận ngay khi open(),
+     *        buffer mạng theo Config::VLC_NETWORK_CACHING_MS.
      * @return true nếu mở thành công, false nếu thất bại
      */
-    bool open(const std::string& video_path);
+    bool open(const std::string& video_path) override;
     
     /**
      * @brief Kiểm tra video đã mở thành công chưa
      * @return true nếu đã mở, false nếu chưa
      */
-    bool isOpened() const;
+    bool isOpened() const override;
     
     /**
      * @brief Đọc frame tiếp theo từ video
      * @param frame Mat để lưu frame đọc được
      * @return true nếu đọc thành công, false nếu hết video
      */
-    bool read(cv::Mat& frame);
+    bool read(cv::Mat& frame) override;
     
     /**
      * @brief Lấy property của video (tương tự cv::VideoCapture::get)
      * @param prop Property cần lấy (CAP_PROP_FRAME_WIDTH, CAP_PROP_FPS, etc.)
      * @return Giá trị property, -1 nếu không hỗ trợ
      */
-    double get(int prop) const;
+    double get(int prop) const override;
+    cv::Size nativeFrameSize() const override;
     
     /**
      * @brief Đóng video và giải phóng tài nguyên
      */
-    void release();
+    void release() override;
     
     /**
      * @brief Set video property (seek, etc.)
+     * 
+     * Với Ring/Offline và có frame index: CAP_PROP_POS_FRAMES seek chính xác tới frame
+     * yêu cầu (frame đọc tiếp theo đúng là frame đó), chi phí giới hạn bởi khoảng cách
+     * tới keyframe gần nhất phía trước. Lần seek đầu tiên load / build frame index (chờ
+     * demux cả file nếu chưa có <video>.fidx). Trả false nếu VLC không về được đúng frame.
      * @param prop Property cần set
      * @param value Giá trị
      * @return true nếu thành công
      */
-    bool set(int prop, double value);
+    bool set(int prop, double value) override;
     
     // Operator để tương thích với OpenCV VideoCapture
     VLCVideoReader& operator>>(cv::Mat& frame);
+    
+    std::string name() const override { return "vlc"; }
+    
+    ChannelOrder channelOrder() const override {
+        return layout_ == PixelLayout::RGB ? ChannelOrder::RGB : ChannelOrder::BGR;
+    }
+    
+    /**
+     * @brief Metadata đã parse của 1 file, cache theo đường dẫn cho cả process
+     * (mở lại cùng file -> không parse lại)
+     */
+    struct MediaInfo {
+        bool parsed = false;
+        unsigned int width = 0;
+        unsigned int height = 0;
+        double fps = 0.0;
+        int total_frames = 0;
+    };
+    
+    /**
+     * @brief libVLC instance dùng chung cho cả process (thread-safe, tạo 1 lần)
+     */
+    static libvlc_instance_t* shared_instance();
+    
+    /**
+     * @brief Chọn chế độ decode (phải gọi trước open())
+     * @param mode Stepped, Ring hoặc Offline
+     * @param ring_slots Số slot trong ring (chỉ dùng cho Ring/Offline, tối thiểu 2)
+     */
+    void setDecodeMode(DecodeMode mode, size_t ring_slots = 8);
+    
+    /**
+     * @brief Chọn chính sách bỏ frame (gọi sau setDecodeMode, trước open())
+     * setDecodeMode đặt mặc định: Ring -> DropOldest, Offline -> Block
+     */
+    void setDropPolicy(DropPolicy policy);
+    
+    /**
+     * @brief Chọn layout kênh màu cho readLease() (phải gọi trước open())
+     */
+    void setPixelLayout(PixelLayout layout);
+    
+    // setOutputSize() (FrameSource): VLC scale ngay khi decode qua format_setup, pool ring
+    // chỉ cấp phát ở kích thước output. Frame index / FPS / số frame không đổi.
+    
+    /**
+     * @brief Tách frame I420/NV12 (lease từ readLease) thành view của từng plane
+     * @param frame Mat CV_8UC1 liên tục, cao h*3/2
+     * @param layout PixelLayout::I420 hoặc PixelLayout::NV12
+     */
+    static YUVPlanes planes(const cv::Mat& frame, PixelLayout layout);
+    
+    /**
+     * @brief Bật/tắt frame index (mặc định bật, phải gọi trước open())
+     */
+    void setUseFrameIndex(bool enabled);
+    
+    /**
+     * @brief Đọc frame tiếp theo dưới dạng lease (zero-copy với Ring/Offline)
+     * @param lease Lease trỏ vào buffer trong pool, layout theo setPixelLayout()
+     * @return true nếu đọc thành công, false nếu hết video
+     * 
+     * Pool có VLC_RING_SLOTS buffer; consumer không nên giữ quá (slots - 2) lease cùng lúc,
+     * nếu không VLC sẽ phải bỏ frame (Ring) hoặc dừng decode chờ lease được trả (Offline).
+     */
+    bool readLease(FrameLease& lease) override;
+    
+    /**
+     * @brief Số frame VLC đã decode và đưa vào ring
+     */
+    uint64_t getDecodedFrames() const;
+    
+    /**
+     * @brief Số frame bị bỏ theo DropPolicy (ring đầy, hoặc bị frame mới hơn thay thế với KeepLatest)
+     */
+    uint64_t getDroppedFrames() const;
+    
+    /**
+     * @brief Số frame tới tay consumer trễ hơn 1 chu kỳ frame so với lúc VLC giao
+     * (chỉ đếm với Ring, tức nguồn chạy theo đồng hồ thật; Offline luôn decode trước)
+     */
+    uint64_t getLateFrames() const;
+    
+    /**
+     * @brief true nếu nguồn đang mở là URL stream thay vì file
+     */
+    bool isStream() const { return is_stream_; }
+    
+    /**
+     * @brief Đường dẫn có phải URL stream không (có scheme "xxx://" khác file://)
+     */
+    static bool isStreamUrl(const std::string& path);
+    
+    /**
+     * @brief Tốc độ decode thực tế (frame/giây), tính từ frame đầu tiên đến frame mới nhất
+     * Dùng để so sánh chế độ Ring (theo fps của file) với Offline trên cùng 1 video
+     */
+    double getDecodeFps() const;
+    
+    /**
+     * @brief Thời gian từ lúc gọi open() tới khi VLC giao frame đầu tiên (ms), -1 nếu chưa có
+     * open() không còn chờ parse: metadata được điền bất đồng bộ qua event của libVLC
+     */
+    double getTimeToFirstFrameMs() const;
 
 private:
     libvlc_instance_t* vlc_instance_;
     libvlc_media_player_t* media_player_;
-    libvlc_media_t* media_;
+    libvlc_media_t* media_;                 // Tạo lại mỗi lần seek (option :start-time không cộng dồn)
     
     bool is_opened_;
+    
+    // Metadata: được điền bất đồng bộ (event parse xong / format_setup), bảo vệ bởi metadata_mutex_
     unsigned int frame_width_;
     unsigned int frame_height_;
     double fps_;
     int total_frames_;
+    mutable std::mutex metadata_mutex_;
+    mutable std::condition_variable metadata_cv_;
+    bool parse_done_;
+    bool format_known_;
+    std::chrono::steady_clock::time_point open_time_;
+    double first_frame_ms_;
     
-    // Buffer để lưu frame data
+    // Buffer để lưu frame data (chế độ Stepped)
     cv::Mat frame_buffer_;
     std::mutex frame_mutex_;
     std::atomic<bool> frame_ready_;
     std::atomic<bool> format_setup_;
     
+    // Ring buffer / pool (chế độ Ring và Offline)
+    // Mỗi slot: free -> VLC đang ghi -> ready -> consumer đang giữ (read/lease) -> free
+    // Được chia sẻ qua shared_ptr để lease còn sống sau release() vẫn trả slot an toàn
+    struct RingState {
+        std::mutex mutex;
+        std::condition_variable frame_cv;      // Báo có frame mới cho read()
+        std::condition_variable slot_free_cv;  // Báo có slot trống cho lock() (chế độ Offline)
+        std::vector<cv::Mat> slots;
+        std::vector<int> free_slots;
+        std::deque<int> ready_slots;
+        // Ảnh lock() đã giao cho VLC, chờ display(). VLC không display theo thứ tự lock (B-frame,
+        // vout bỏ ảnh trễ) -> mỗi ảnh có id riêng, display() nhận đúng ảnh theo id
+        struct LockedPicture {
+            uint64_t id;
+            int slot;                          // -1 = scratch
+            std::chrono::steady_clock::time_point locked_at;
+        };
+        std::deque<LockedPicture> locked;
+        uint64_t next_picture_id = 1;          // 0 không dùng (VLC coi id là con trỏ)
+        std::vector<int64_t> slot_frame_numbers;  // Số thứ tự frame đang nằm trong mỗi slot
+        std::vector<std::chrono::steady_clock::time_point> slot_display_times;  // Lúc VLC giao frame
+        int64_t next_frame_number = 0;             // Số thứ tự gán cho frame display() tiếp theo
+        cv::Mat scratch;                       // Dùng khi không còn slot nào (frame sẽ bị bỏ)
+        uint64_t generation = 0;               // Tăng khi cấp phát lại -> lease cũ không trả nhầm slot
+        bool end_of_stream = false;
+        bool stopping = false;                 // release() đang dừng player -> lock() không được chặn
+        
+        // Seek chính xác: VLC bắt đầu hiển thị từ keyframe (frame index), số thứ tự đếm tiếp từ
+        // keyframe, bỏ các frame trước frame đích; seekToFrame chờ frame đích
+        bool seek_pending = false;
+        int64_t seek_target = 0;
+        int64_t seek_landed = -1;              // Số thứ tự frame đầu tiên được giữ sau seek
+        std::chrono::steady_clock::time_point first_frame_time;
+        std::chrono::steady_clock::time_point last_frame_time;
+        
+        void returnSlot(int slot, uint64_t slot_generation);
+        // Ring cạn: lấy lại slot của ảnh lock quá VLC_LOST_PICTURE_MS chưa display, trả về số ảnh lấy lại
+        size_t reclaimLost(std::chrono::steady_clock::time_point now);
+    };
+    
+    DecodeMode mode_;
+    DropPolicy drop_policy_;
+    size_t ring_capacity_;
+    std::shared_ptr<RingState> ring_;
+    std::atomic<uint64_t> decoded_frames_;
+    std::atomic<uint64_t> dropped_frames_;
+    std::atomic<uint64_t> late_frames_;
+    bool is_stream_;
+    
+    // Frame index (PTS + keyframe), vị trí frame đọc tiếp theo
+    std::string video_path_;
+    std::shared_ptr<const FrameIndex> index_;
+    bool use_index_;
+    int64_t position_;
+    
+    // Layout consumer muốn và layout VLC thực sự ghi vào buffer
+    PixelLayout layout_;
+    PixelLayout vlc_layout_;
+    
     // Callback functions
     static void* lock(void* data, void** p_pixels);
     static void unlock(void* data, void* id, void* const* p_pixels);
     static void display(void* data, void* id);
     static unsigned format_setup(void** opaque, char* chroma, unsigned* width, unsigned* height, unsigned* pitches, unsigned* lines);
     static void format_cleanup(void* opaque);
+    static void handle_event(const libvlc_event_t* event, void* data);
+    
+    /**
+     * @brief Đăng ký callbacks/events và bắt đầu parse bất đồng bộ (không chờ kết quả)
+     * @param cached Metadata trong cache (nullptr nếu file chưa được mở lần nào)
+     */
+    bool initializeVideoInfo(const MediaInfo* cached);
+    
+    static std::shared_ptr<const MediaInfo> media_cache_lookup(const std::string& path);
+    static void media_cache_store(const std::string& path, const MediaInfo& info);
+    
+    /**
+     * @brief Frame index của file, load / build 1 lần cho cả process (các thread gọi cùng lúc
+     * chờ chung 1 lần build). build = false: chỉ trả index đã có, không chờ
+     */
+    static std::shared_ptr<const FrameIndex> shared_frame_index(const std::string& path, bool build);
+    
+    /**
+     * @brief Load / build frame index khi cần seek lần đầu; cập nhật FPS / số frame theo index
+     * @return false nếu không có index (stream, tắt index, không demux được)
+     */
+    bool ensureIndex();
+    
+    /**
+     * @brief Tạo media cho video_path_ với các option theo chế độ decode
+     * @param start_seconds > 0: thêm :start-time (seek)
+     */
+    libvlc_media_t* createMedia(double start_seconds) const;
+    
+    /**
+     * @brief Đọc track info khi VLC báo parse xong (chạy trên thread của libVLC)
+     */
+    void onParsed();
+    
+    /**
+     * @brief Chờ metadata cần cho prop (tối đa Config::VLC_PARSE_TIMEOUT_MS)
+     * @return false nếu hết thời gian chờ
+     */
+    bool waitForMetadata(int prop) const;
+    
+    double elapsedSinceOpenMs() const;
+    void startPlayback();
+    
+    /**
+     * @brief Đọc frame theo từng chế độ
+     */
+    bool readStepped(cv::Mat& frame);
+    bool readRing(cv::Mat& frame);
+    
+    /**
+     * @brief Lấy slot ready tiếp theo dưới dạng lease thô (layout do VLC ghi, chưa đảo kênh)
+     */
+    bool acquireSlot(FrameLease& lease);
+    
+    /**
+     * @brief Trả các frame chưa đọc trong ring về danh sách slot trống
+     */
+    void flushRing();
+    
+    /**
+     * @brief Seek chính xác bằng frame index: dừng player, phát lại media mới từ PTS của frame
+     * (VLC decode từ keyframe trước đó và bỏ các frame trước vị trí start-time), rồi chờ frame
+     * đầu tiên: số thứ tự suy từ thời điểm phát, frame sớm hơn đích bị bỏ
+     * @return false nếu hết thời gian chờ hoặc VLC bắt đầu sau frame đích
+     */
+    bool seekToFrame(int frame_number);
+    
+    bool usesRing() const { return mode_ != DecodeMode::Stepped; }
+    static bool isPlanar(PixelLayout layout) { return layout == PixelLayout::I420 || layout == PixelLayout::NV12; }
     
     /**
-     * @brief Khởi tạo và lấy thông tin video
+     * @brief Gán con trỏ từng plane của buffer cho VLC (lock callback)
      */
-    bool initializeVideoInfo();
+    static void setPlanePointers(const cv::Mat& buffer, PixelLayout layout, void** p_pixels);
+    bool hasIndex() const { return index_ && !index_->empty(); }
 };
 